@@ -0,0 +1,97 @@
+#include "BloomFilter.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "Mix.hpp"
+
+BloomFilter::BloomFilter(const std::size_t capacity, const double falsePositiveRate)
+: blocks_(nullptr), nBlocks_(1), nHashes_(1), capacity_(capacity),
+  falsePositiveRate_(clampRate(falsePositiveRate))
+{
+    const double ln2 = std::log(2.0);
+    const double nKeys = (capacity == 0) ? 1.0 : static_cast<double>(capacity);
+    const double nBits = -nKeys * std::log(falsePositiveRate_) / (ln2 * ln2);
+
+    if (nBits > BlockBits) nBlocks_ = static_cast<std::size_t>(std::ceil(nBits / BlockBits));
+
+    const long nHashes = std::lround(nBits / nKeys * ln2);
+    if (nHashes > 16) {
+        nHashes_ = 16;
+    } else if (nHashes > 1) {
+        nHashes_ = nHashes;
+    }
+
+    blocks_ = static_cast<Block *>(std::aligned_alloc(BlockSize, nBlocks_ * sizeof(Block)));
+    clear();
+}
+
+BloomFilter::~BloomFilter()
+{
+    std::free(blocks_);
+}
+
+double BloomFilter::clampRate(const double falsePositiveRate)
+{
+    if (!(falsePositiveRate >= MinFalsePositiveRate)) return MinFalsePositiveRate;
+    if (falsePositiveRate > MaxFalsePositiveRate) return MaxFalsePositiveRate;
+
+    return falsePositiveRate;
+}
+
+std::size_t BloomFilter::blockIdx(const unsigned long long mixed) const
+{
+    return static_cast<std::size_t>(((mixed >> 32) * nBlocks_) >> 32);
+}
+
+void BloomFilter::insert(const unsigned long long hash)
+{
+    const unsigned long long mixed = mix64(hash);
+    Block &block = blocks_[blockIdx(mixed)];
+
+    unsigned long long bitIdx = mixed;
+    const unsigned long long step = (mixed >> 16) | 1;
+    for (std::size_t i = 0; i < nHashes_; ++i, bitIdx += step) {
+        block.words[(bitIdx % BlockBits) / WordBits] |= 1ull << (bitIdx % WordBits);
+    }
+}
+
+bool BloomFilter::mayContain(const unsigned long long hash) const
+{
+    const unsigned long long mixed = mix64(hash);
+    const Block &block = blocks_[blockIdx(mixed)];
+
+    unsigned long long bitIdx = mixed;
+    const unsigned long long step = (mixed >> 16) | 1;
+    for (std::size_t i = 0; i < nHashes_; ++i, bitIdx += step) {
+        if (!(block.words[(bitIdx % BlockBits) / WordBits] & (1ull << (bitIdx % WordBits)))) return false;
+    }
+
+    return true;
+}
+
+void BloomFilter::clear()
+{
+    std::memset(blocks_, 0, nBlocks_ * sizeof(Block));
+}
+
+std::size_t BloomFilter::capacity() const
+{
+    return capacity_;
+}
+
+std::size_t BloomFilter::nHashes() const
+{
+    return nHashes_;
+}
+
+double BloomFilter::falsePositiveRate() const
+{
+    return falsePositiveRate_;
+}
+
+std::size_t BloomFilter::memoryUsage() const
+{
+    return nBlocks_ * sizeof(Block);
+}
@@ -0,0 +1,49 @@
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <cstddef>
+#include <climits>
+
+class BloomFilter {
+public:
+    static const std::size_t BlockSize = 64;
+    // Rates outside [MinFalsePositiveRate, MaxFalsePositiveRate], NaN included, are clamped into it.
+    static constexpr double MinFalsePositiveRate = 1e-9;
+    static constexpr double MaxFalsePositiveRate = 0.5;
+
+    BloomFilter() = delete;
+    BloomFilter(std::size_t capacity, double falsePositiveRate);
+
+    BloomFilter(const BloomFilter &) = delete;
+    BloomFilter &operator=(const BloomFilter &) = delete;
+
+    ~BloomFilter();
+
+    void insert(unsigned long long hash);
+    bool mayContain(unsigned long long hash) const;
+    void clear();
+
+    std::size_t capacity() const;
+    std::size_t nHashes() const;
+    double falsePositiveRate() const;
+    std::size_t memoryUsage() const;
+
+private:
+    static const std::size_t BlockBits = BlockSize * CHAR_BIT;
+    static const std::size_t WordBits = CHAR_BIT * sizeof(unsigned long long);
+
+    struct alignas(BlockSize) Block {
+        unsigned long long words[BlockSize / sizeof(unsigned long long)];
+    };
+
+    static double clampRate(double falsePositiveRate);
+    std::size_t blockIdx(unsigned long long mixed) const;
+
+    Block *blocks_;
+    std::size_t nBlocks_;
+    std::size_t nHashes_;
+    std::size_t capacity_;
+    double falsePositiveRate_;
+};
+
+#endif /* BLOOMFILTER_HPP */
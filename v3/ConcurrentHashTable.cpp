@@ -0,0 +1,250 @@
+#include "ConcurrentHashTable.hpp"
+
+#include <new>
+
+#include "EpochReclaimer.hpp"
+
+ConcurrentHashTable::ConcurrentHashTable(unsigned long long (*const hashFunc)(const ConcurrentHashTable::String &),
+                                         const std::size_t nStripes)
+: table_(nullptr), stripes_(nullptr), stripeMask_(0), hashFunc_(hashFunc)
+{
+    std::size_t nStripesPow2 = 1;
+    while (nStripesPow2 < nStripes) nStripesPow2 <<= 1;
+
+    stripes_ = new RwSpinLock[nStripesPow2];
+    stripeMask_ = nStripesPow2 - 1;
+
+    table_.store(createTable((nStripesPow2 > InitialBuckets) ? nStripesPow2 : InitialBuckets),
+                 std::memory_order_relaxed);
+}
+
+ConcurrentHashTable::~ConcurrentHashTable()
+{
+    Table *table = table_.load(std::memory_order_relaxed);
+    while (table != nullptr) {
+        Table *next = table->next.load(std::memory_order_relaxed);
+        destroyTable(table);
+        table = next;
+    }
+
+    EpochReclaimer::instance().reclaim(this);
+    delete[] stripes_;
+}
+
+ConcurrentHashTable::Table *ConcurrentHashTable::createTable(const std::size_t nBuckets)
+{
+    auto table = new (std::malloc(sizeof(Table))) Table{};
+    table->nBuckets = nBuckets;
+    table->lists = static_cast<DoublyLinkedArrayList<Entry> *>(std::malloc(nBuckets * sizeof(*table->lists)));
+    table->moved = static_cast<bool *>(std::calloc(nBuckets, sizeof(*table->moved)));
+
+    for (std::size_t bucket = 0; bucket < nBuckets; ++bucket) new (&table->lists[bucket]) DoublyLinkedArrayList<Entry>;
+
+    return table;
+}
+
+void ConcurrentHashTable::destroyTable(ConcurrentHashTable::Table *const table)
+{
+    for (std::size_t bucket = 0; bucket < table->nBuckets; ++bucket) {
+        if (!table->moved[bucket]) table->lists[bucket].~DoublyLinkedArrayList();
+    }
+
+    std::free(table->lists);
+    std::free(table->moved);
+    std::free(table);
+}
+
+void ConcurrentHashTable::retireTable(ConcurrentHashTable::Table *const table)
+{
+    EpochReclaimer &reclaimer = EpochReclaimer::instance();
+
+    reclaimer.retire(table->lists, table->nBuckets * sizeof(*table->lists), this);
+    reclaimer.retire(table->moved, table->nBuckets * sizeof(*table->moved), this);
+    reclaimer.retire(table, sizeof(*table), this);
+}
+
+RwSpinLock &ConcurrentHashTable::stripeOf(const std::size_t bucket) const
+{
+    return stripes_[bucket & stripeMask_];
+}
+
+void ConcurrentHashTable::resize(ConcurrentHashTable::Table *const table)
+{
+    if (table != table_.load(std::memory_order_acquire)) return;
+
+    Table *next = table->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+        Table *created = createTable(table->nBuckets * 2);
+        if (table->next.compare_exchange_strong(next, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            next = created;
+        } else {
+            destroyTable(created);
+        }
+    }
+
+    helpTransfer(table, next);
+}
+
+void ConcurrentHashTable::helpTransfer(ConcurrentHashTable::Table *const table, ConcurrentHashTable::Table *const next)
+{
+    for (;;) {
+        const std::size_t start = table->transferIdx.fetch_add(TransferChunk, std::memory_order_relaxed);
+        if (start >= table->nBuckets) return;
+
+        const std::size_t end = (start + TransferChunk < table->nBuckets) ? start + TransferChunk : table->nBuckets;
+        for (std::size_t bucket = start; bucket < end; ++bucket) transferBucket(table, next, bucket);
+
+        if (table->nTransferred.fetch_add(end - start, std::memory_order_acq_rel) + (end - start) == table->nBuckets) {
+            table_.store(next, std::memory_order_release);
+            retireTable(table);
+
+            return;
+        }
+    }
+}
+
+void ConcurrentHashTable::transferBucket(ConcurrentHashTable::Table *const table,
+                                         ConcurrentHashTable::Table *const next, const std::size_t bucket)
+{
+    auto &list = table->lists[bucket];
+
+    RwSpinLock &stripe = stripeOf(bucket);
+    stripe.lock();
+    for (auto node = list.tailNode(); node->curr != 0; node = list.nodeAfterPhysicalPos(node->curr)) {
+        const unsigned long long hash = hashFunc_(*node->data.key);
+        next->lists[hash & (next->nBuckets - 1)].insertAfterHead(node->data, tagOf(hash));
+    }
+    table->moved[bucket] = true;
+    list.~DoublyLinkedArrayList();
+    stripe.unlock();
+}
+
+void ConcurrentHashTable::insert(const ConcurrentHashTable::Entry &entry)
+{
+    insert(*entry.key, *entry.val);
+}
+
+void ConcurrentHashTable::insert(const ConcurrentHashTable::String &key, const ConcurrentHashTable::String &val)
+{
+    const unsigned long long hash = hashFunc_(key);
+    Entry entry{.key = &key, .val = &val};
+    const unsigned char tag = tagOf(hash);
+
+    EpochReclaimer::Guard guard;
+
+    Table *table = table_.load(std::memory_order_acquire);
+    bool inserted = false;
+    for (;;) {
+        const std::size_t bucket = hash & (table->nBuckets - 1);
+
+        RwSpinLock &stripe = stripeOf(bucket);
+        stripe.lock();
+        if (!table->moved[bucket]) {
+            auto &list = table->lists[bucket];
+            inserted = list.findNodeByValue(entry, tag) == nullptr;
+            if (inserted) list.insertAfterHead(entry, tag);
+            stripe.unlock();
+            break;
+        }
+        stripe.unlock();
+
+        Table *next = table->next.load(std::memory_order_acquire);
+        helpTransfer(table, next);
+        table = next;
+    }
+
+    if (inserted && (size_.fetch_add(1, std::memory_order_relaxed) + 1 >
+                     static_cast<std::ptrdiff_t>(table->nBuckets * MaxLoad))) {
+        resize(table);
+    } else if (Table *next = table->next.load(std::memory_order_acquire)) {
+        helpTransfer(table, next);
+    }
+}
+
+bool ConcurrentHashTable::remove(const ConcurrentHashTable::String &key)
+{
+    const unsigned long long hash = hashFunc_(key);
+    const Entry entry{.key = &key, .val = nullptr};
+    const unsigned char tag = tagOf(hash);
+
+    EpochReclaimer::Guard guard;
+
+    Table *table = table_.load(std::memory_order_acquire);
+    for (;;) {
+        const std::size_t bucket = hash & (table->nBuckets - 1);
+
+        RwSpinLock &stripe = stripeOf(bucket);
+        stripe.lock();
+        if (!table->moved[bucket]) {
+            auto &list = table->lists[bucket];
+            auto node = list.findNodeByValue(entry, tag);
+            if (node != nullptr) list.deleteFromPhysicalPos(node->curr);
+            stripe.unlock();
+
+            if (node != nullptr) size_.fetch_sub(1, std::memory_order_relaxed);
+
+            return node != nullptr;
+        }
+        stripe.unlock();
+
+        table = table->next.load(std::memory_order_acquire);
+    }
+}
+
+const ConcurrentHashTable::String *ConcurrentHashTable::find(const ConcurrentHashTable::String &key) const
+{
+    const unsigned long long hash = hashFunc_(key);
+    const Entry entry{.key = &key, .val = nullptr};
+    const unsigned char tag = tagOf(hash);
+
+    EpochReclaimer::Guard guard;
+
+    const Table *table = table_.load(std::memory_order_acquire);
+    for (;;) {
+        const std::size_t bucket = hash & (table->nBuckets - 1);
+
+        RwSpinLock &stripe = stripeOf(bucket);
+        stripe.lockShared();
+        if (!table->moved[bucket]) {
+            auto node = table->lists[bucket].findNodeByValue(entry, tag);
+            const String *val = (node == nullptr) ? nullptr : node->data.val;
+            stripe.unlockShared();
+
+            return val;
+        }
+        stripe.unlockShared();
+
+        table = table->next.load(std::memory_order_acquire);
+    }
+}
+
+void ConcurrentHashTable::clear()
+{
+    EpochReclaimer::Guard guard;
+
+    for (std::size_t stripe = 0; stripe <= stripeMask_; ++stripe) stripes_[stripe].lock();
+
+    for (Table *table = table_.load(std::memory_order_acquire); table != nullptr;
+         table = table->next.load(std::memory_order_acquire)) {
+        for (std::size_t bucket = 0; bucket < table->nBuckets; ++bucket) {
+            if (!table->moved[bucket]) table->lists[bucket].clear();
+        }
+    }
+    size_.store(0, std::memory_order_relaxed);
+
+    for (std::size_t stripe = 0; stripe <= stripeMask_; ++stripe) stripes_[stripe].unlock();
+}
+
+std::size_t ConcurrentHashTable::size() const
+{
+    const std::ptrdiff_t size = size_.load(std::memory_order_relaxed);
+
+    return (size < 0) ? 0 : static_cast<std::size_t>(size);
+}
+
+std::size_t ConcurrentHashTable::capacity() const
+{
+    EpochReclaimer::Guard guard;
+
+    return table_.load(std::memory_order_acquire)->nBuckets;
+}
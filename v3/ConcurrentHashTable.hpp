@@ -0,0 +1,69 @@
+#ifndef CONCURRENTHASHTABLE_HPP
+#define CONCURRENTHASHTABLE_HPP
+
+#include <atomic>
+
+#include "HashTable.hpp"
+#include "RwSpinLock.hpp"
+
+class ConcurrentHashTable {
+public:
+    typedef HashTable::String String;
+    typedef HashTable::Entry Entry;
+
+    static const std::size_t DefaultStripes = 64;
+
+    ConcurrentHashTable() = delete;
+    explicit ConcurrentHashTable(unsigned long long (*hashFunc)(const String &), std::size_t nStripes = DefaultStripes);
+
+    ConcurrentHashTable(const ConcurrentHashTable &) = delete;
+    ConcurrentHashTable &operator=(const ConcurrentHashTable &) = delete;
+
+    ~ConcurrentHashTable();
+
+    void insert(const Entry &entry);
+    void insert(const String &key, const String &val);
+    bool remove(const String &key);
+    const String *find(const String &key) const;
+
+    void clear();
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+
+private:
+    struct Table {
+        std::size_t nBuckets;
+        DoublyLinkedArrayList<Entry> *lists;
+        bool *moved;
+
+        std::atomic<std::size_t> transferIdx;
+        std::atomic<std::size_t> nTransferred;
+        std::atomic<Table *> next;
+    };
+
+    static const std::size_t InitialBuckets = 1024;
+    static const std::size_t MaxLoad = 4;
+    static const std::size_t TransferChunk = 16;
+
+    static Table *createTable(std::size_t nBuckets);
+    static void destroyTable(Table *table);
+    void retireTable(Table *table);
+
+    RwSpinLock &stripeOf(std::size_t bucket) const;
+
+    void resize(Table *table);
+    void helpTransfer(Table *table, Table *next);
+    void transferBucket(Table *table, Table *next, std::size_t bucket);
+
+    std::atomic<Table *> table_;
+    // Signed: a remove can decrement before the insert it undoes has incremented, so the count may dip below zero.
+    std::atomic<std::ptrdiff_t> size_{0};
+
+    RwSpinLock *stripes_;
+    std::size_t stripeMask_;
+
+    unsigned long long (*hashFunc_)(const String &);
+};
+
+#endif /* CONCURRENTHASHTABLE_HPP */
@@ -3,9 +3,12 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 
 #include <type_traits>
 
+#include "TagMatch.hpp"
+
 #ifndef NDEBUG
 #define VALIDATE_LIST validate()
 #else
@@ -37,10 +40,10 @@ public:
 
     ~DoublyLinkedArrayList();
 
-    size_t insertAfterPhysicalPos(size_t physicalPos, T val);
-    size_t insertBeforePhysicalPos(size_t physicalPos, T val);
-    size_t insertBeforeTail(const T &val);
-    size_t insertAfterHead(const T &val);
+    size_t insertAfterPhysicalPos(size_t physicalPos, T val, unsigned char tag = 0);
+    size_t insertBeforePhysicalPos(size_t physicalPos, T val, unsigned char tag = 0);
+    size_t insertBeforeTail(const T &val, unsigned char tag = 0);
+    size_t insertAfterHead(const T &val, unsigned char tag = 0);
 
     void deleteFromPhysicalPos(size_t physicalPos);
     void deleteHead();
@@ -58,25 +61,46 @@ public:
     bool isValid() const;
     void validate() const;
     void clear();
+    void shrinkToFit();
 
     Node *findNodeByValue(T val) const;
+    Node *findNodeByValue(T val, unsigned char tag) const;
+    // For readers racing a single writer: returns a copy that may be torn, so the caller must validate it.
+    bool findValueConcurrent(const T &val, unsigned char tag, T &found) const;
     Node *findNodeByLogicalPos(size_t logicalPos) const;
+    void prefetchTags() const;
+
+    void setRetireFunc(void (*func)(void *ctx, void *ptr, size_t bytes), void *ctx);
 
 private:
     static const size_t growCoeff = 16;
+    static const size_t defaultCapacity = 16;
 
     Node *nodes;
+    unsigned char *tags;
 
     size_t headPos{};
     size_t tailPos{};
     size_t freeListHeadPos{};
 
+    void (*retireFunc)(void *ctx, void *ptr, size_t bytes){};
+    void *retireCtx{};
+
     size_t findFreePos();
     void addToFree(size_t physicalPos);
 
     void grow();
 
+    static size_t tagsSize(size_t capacity);
+
     void createFreePosList(size_t freeListNewHeadPos);
+    void fillFreePositions(Node *nodes, unsigned char *tags, size_t firstPos, size_t capacity) const;
+
+    // A list with a retire function has readers in findValueConcurrent(), so its data and tags are written with
+    // atomic stores, the data word by word.
+    void storeData(T &dst, const T &src) const;
+    static T loadData(const T &src);
+    void storeTag(unsigned char &dst, unsigned char tag) const;
 
     bool checkInsertPhysicalPosCorrectness(size_t physicalPos) const;
     bool checkDeletePhysicalPosCorrectness(size_t physicalPos) const;
@@ -85,8 +109,8 @@ private:
 
 template<typename T>
 DoublyLinkedArrayList<T>::DoublyLinkedArrayList(size_t capacity)
-: sorted(false), size(0), capacity(capacity), nodes((Node *) std::calloc(capacity + 1, sizeof(*nodes))), headPos(0), tailPos(0),
-  freeListHeadPos(0)
+: sorted(false), size(0), capacity(capacity), nodes((Node *) std::calloc(capacity + 1, sizeof(*nodes))),
+  tags((unsigned char *) std::calloc(tagsSize(capacity), sizeof(*tags))), headPos(0), tailPos(0), freeListHeadPos(0)
 {
     createFreePosList(1);
 
@@ -99,10 +123,11 @@ DoublyLinkedArrayList<T>::~DoublyLinkedArrayList()
     VALIDATE_LIST;
 
     std::free(nodes);
+    std::free(tags);
 }
 
 template<typename T>
-size_t DoublyLinkedArrayList<T>::insertAfterPhysicalPos(size_t physicalPos, T val)
+size_t DoublyLinkedArrayList<T>::insertAfterPhysicalPos(size_t physicalPos, T val, unsigned char tag)
 {
     VALIDATE_LIST;
 
@@ -112,7 +137,7 @@ size_t DoublyLinkedArrayList<T>::insertAfterPhysicalPos(size_t physicalPos, T va
 
     if (physicalPos == headPos) {
         VALIDATE_LIST;
-        return insertAfterHead(val);
+        return insertAfterHead(val, tag);
     }
 
     size_t freePhysicalPos = findFreePos();
@@ -126,7 +151,8 @@ size_t DoublyLinkedArrayList<T>::insertAfterPhysicalPos(size_t physicalPos, T va
     nodes[physicalPos].next = freePhysicalPos;
     nodes[nodes[freePhysicalPos].next].prev = freePhysicalPos;
     nodes[freePhysicalPos].prev = physicalPos;
-    nodes[freePhysicalPos].data = val;
+    storeData(nodes[freePhysicalPos].data, val);
+    storeTag(tags[freePhysicalPos], tag);
     sorted = false;
     ++size;
 
@@ -135,7 +161,7 @@ size_t DoublyLinkedArrayList<T>::insertAfterPhysicalPos(size_t physicalPos, T va
 }
 
 template<typename T>
-size_t DoublyLinkedArrayList<T>::insertBeforePhysicalPos(size_t physicalPos, const T val)
+size_t DoublyLinkedArrayList<T>::insertBeforePhysicalPos(size_t physicalPos, const T val, unsigned char tag)
 {
     VALIDATE_LIST;
 
@@ -145,7 +171,7 @@ size_t DoublyLinkedArrayList<T>::insertBeforePhysicalPos(size_t physicalPos, con
 
     if (physicalPos == tailPos) {
         VALIDATE_LIST;
-        return insertBeforeTail(val);
+        return insertBeforeTail(val, tag);
     }
 
     size_t freePhysicalPos = findFreePos();
@@ -159,7 +185,8 @@ size_t DoublyLinkedArrayList<T>::insertBeforePhysicalPos(size_t physicalPos, con
     nodes[freePhysicalPos].prev = nodes[physicalPos].prev;
     nodes[physicalPos].prev = freePhysicalPos;
     nodes[nodes[freePhysicalPos].prev].next = freePhysicalPos;
-    nodes[freePhysicalPos].data = val;
+    storeData(nodes[freePhysicalPos].data, val);
+    storeTag(tags[freePhysicalPos], tag);
     sorted = false;
     ++size;
 
@@ -168,7 +195,7 @@ size_t DoublyLinkedArrayList<T>::insertBeforePhysicalPos(size_t physicalPos, con
 }
 
 template<typename T>
-size_t DoublyLinkedArrayList<T>::insertBeforeTail(const T &val)
+size_t DoublyLinkedArrayList<T>::insertBeforeTail(const T &val, unsigned char tag)
 {
     VALIDATE_LIST;
 
@@ -189,7 +216,8 @@ size_t DoublyLinkedArrayList<T>::insertBeforeTail(const T &val)
     nodes[freePhysicalPos].curr = freePhysicalPos;
     nodes[freePhysicalPos].next = tailPos;
     nodes[freePhysicalPos].prev = 0;
-    nodes[freePhysicalPos].data = val;
+    storeData(nodes[freePhysicalPos].data, val);
+    storeTag(tags[freePhysicalPos], tag);
     tailPos = freePhysicalPos;
     sorted = false;
     ++size;
@@ -199,7 +227,7 @@ size_t DoublyLinkedArrayList<T>::insertBeforeTail(const T &val)
 }
 
 template<typename T>
-size_t DoublyLinkedArrayList<T>::insertAfterHead(const T &val)
+size_t DoublyLinkedArrayList<T>::insertAfterHead(const T &val, unsigned char tag)
 {
     VALIDATE_LIST;
 
@@ -220,7 +248,8 @@ size_t DoublyLinkedArrayList<T>::insertAfterHead(const T &val)
     nodes[freePhysicalPos].curr = freePhysicalPos;
     nodes[freePhysicalPos].next = 0;
     nodes[freePhysicalPos].prev = headPos;
-    nodes[freePhysicalPos].data = val;
+    storeData(nodes[freePhysicalPos].data, val);
+    storeTag(tags[freePhysicalPos], tag);
     headPos = freePhysicalPos;
     ++size;
 
@@ -277,6 +306,7 @@ void DoublyLinkedArrayList<T>::deleteHead()
     nodes[nodes[headPos].prev].next = 0;
     size_t deletedHeadPos = headPos;
     headPos = nodes[headPos].prev;
+    if (headPos == 0) tailPos = 0;
     addToFree(deletedHeadPos);
     --size;
 
@@ -291,6 +321,7 @@ void DoublyLinkedArrayList<T>::deleteTail()
     nodes[nodes[tailPos].next].prev = 0;
     size_t deletedTailPos = tailPos;
     tailPos = nodes[tailPos].next;
+    if (tailPos == 0) headPos = 0;
     addToFree(deletedTailPos);
     --size;
 
@@ -300,6 +331,9 @@ void DoublyLinkedArrayList<T>::deleteTail()
 template<typename T>
 void DoublyLinkedArrayList<T>::addToFree(size_t physicalPos)
 {
+    storeData(nodes[physicalPos].data, T{});
+    nodes[physicalPos].curr = 0;
+    storeTag(tags[physicalPos], 0);
     nodes[physicalPos].next = freeListHeadPos;
     nodes[physicalPos].prev = 0;
     freeListHeadPos = physicalPos;
@@ -379,9 +413,18 @@ void DoublyLinkedArrayList<T>::sort()
 {
     VALIDATE_LIST;
 
+    if (size == 0) {
+        sorted = true;
+        return;
+    }
+
+    auto sortedTags = (unsigned char *) std::calloc(tagsSize(capacity), sizeof(*tags));
     for (size_t physicalPos = headPos, logicalPos = size; physicalPos != 0; physicalPos = nodes[physicalPos].prev, --logicalPos) {
         nodes[physicalPos].next = logicalPos;
+        sortedTags[logicalPos] = tags[physicalPos];
     }
+    std::free(tags);
+    tags = sortedTags;
 
     size_t freePos = freeListHeadPos;
     while (freePos != 0) {
@@ -396,9 +439,12 @@ void DoublyLinkedArrayList<T>::sort()
     headPos = size;
     nodes[headPos].prev = size - 1;
     nodes[headPos].next = 0;
+    nodes[headPos].curr = headPos;
 
+    // qsort moved every node, so its own position has to be rewritten along with the links.
     for (size_t physicalPos = tailPos; physicalPos < headPos; ++physicalPos) {
         nodes[physicalPos].next = physicalPos + 1;
+        nodes[physicalPos].curr = physicalPos;
         nodes[physicalPos].prev = physicalPos - 1;
     }
 
@@ -459,7 +505,7 @@ typename DoublyLinkedArrayList<T>::Node *DoublyLinkedArrayList<T>::findNodeByVal
 {
     VALIDATE_LIST;
 
-    for (size_t i = 0; i < capacity; ++i) {
+    for (size_t i = 1; i <= capacity; ++i) {
         if (nodes[i].data == val) {
             return nodes + i;
         }
@@ -468,6 +514,69 @@ typename DoublyLinkedArrayList<T>::Node *DoublyLinkedArrayList<T>::findNodeByVal
     return nullptr;
 }
 
+template<typename T>
+typename DoublyLinkedArrayList<T>::Node *DoublyLinkedArrayList<T>::findNodeByValue(T val, unsigned char tag) const
+{
+    VALIDATE_LIST;
+
+    for (size_t base = 0; base <= capacity; base += TagBlockSize) {
+        unsigned matches = matchTags(tags + base, tag);
+        while (matches != 0) {
+            size_t i = base + __builtin_ctz(matches);
+            if (nodes[i].data == val) return nodes + i;
+            matches &= matches - 1;
+        }
+    }
+
+    return nullptr;
+}
+
+template<typename T>
+bool DoublyLinkedArrayList<T>::findValueConcurrent(const T &val, unsigned char tag, T &found) const
+{
+    size_t snapshotCapacity = __atomic_load_n(&capacity, __ATOMIC_ACQUIRE);
+    const Node *snapshotNodes = __atomic_load_n(&nodes, __ATOMIC_ACQUIRE);
+    const unsigned char *snapshotTags = __atomic_load_n(&tags, __ATOMIC_ACQUIRE);
+
+    alignas(TagBlockSize) unsigned char block[TagBlockSize];
+    for (size_t base = 0; base <= snapshotCapacity; base += TagBlockSize) {
+        auto src = reinterpret_cast<const unsigned long long *>(snapshotTags + base);
+        auto dst = reinterpret_cast<unsigned long long *>(block);
+        for (size_t w = 0; w < TagBlockSize / sizeof(*src); ++w) dst[w] = __atomic_load_n(&src[w], __ATOMIC_ACQUIRE);
+
+        unsigned matches = matchTags(block, tag);
+        while (matches != 0) {
+            found = loadData(snapshotNodes[base + __builtin_ctz(matches)].data);
+            if (found == val) return true;
+            matches &= matches - 1;
+        }
+    }
+
+    return false;
+}
+
+template<typename T>
+void DoublyLinkedArrayList<T>::prefetchTags() const
+{
+    // findNodeByValue() with a tag scans every tag block, so bring in all of them.
+    for (size_t offset = 0; offset < tagsSize(capacity); offset += 64) {
+        _mm_prefetch(reinterpret_cast<const char *>(tags + offset), _MM_HINT_T0);
+    }
+}
+
+template<typename T>
+void DoublyLinkedArrayList<T>::setRetireFunc(void (*func)(void *ctx, void *ptr, size_t bytes), void *ctx)
+{
+    retireFunc = func;
+    retireCtx = ctx;
+}
+
+template<typename T>
+size_t DoublyLinkedArrayList<T>::tagsSize(size_t capacity)
+{
+    return (capacity + TagBlockSize) / TagBlockSize * TagBlockSize;
+}
+
 template<typename T>
 void DoublyLinkedArrayList<T>::clear()
 {
@@ -482,6 +591,22 @@ void DoublyLinkedArrayList<T>::clear()
     VALIDATE_LIST;
 }
 
+template<typename T>
+void DoublyLinkedArrayList<T>::shrinkToFit()
+{
+    VALIDATE_LIST;
+
+    if (size != 0) sort();
+
+    capacity = (size < defaultCapacity) ? defaultCapacity : size + 1;
+    nodes = (Node *) std::realloc(nodes, sizeof(Node) * (capacity + 1));
+    tags = (unsigned char *) std::realloc(tags, tagsSize(capacity));
+
+    createFreePosList(size + 1);
+
+    VALIDATE_LIST;
+}
+
 template<typename T>
 typename DoublyLinkedArrayList<T>::Node *DoublyLinkedArrayList<T>::findNodeByLogicalPos(size_t logicalPos) const
 {
@@ -539,15 +664,66 @@ template<typename T>
 void DoublyLinkedArrayList<T>::createFreePosList(size_t freeListNewHeadPos)
 {
     freeListHeadPos = freeListNewHeadPos;
-    for (size_t i = freeListHeadPos; i <= capacity; ++i) {
-        std::memset(&nodes[i].data, 0, sizeof(nodes->data));
+    fillFreePositions(nodes, tags, freeListHeadPos, capacity);
+
+    VALIDATE_LIST;
+}
+
+template<typename T>
+void DoublyLinkedArrayList<T>::fillFreePositions(Node *nodes, unsigned char *tags, size_t firstPos,
+                                                 size_t capacity) const
+{
+    for (size_t i = firstPos; i <= capacity; ++i) {
+        storeData(nodes[i].data, T{});
         nodes[i].curr = 0;
+        storeTag(tags[i], 0);
         nodes[i].next = i + 1;
         nodes[i].prev = 0;
     }
     nodes[capacity].next = 0;
+}
 
-    VALIDATE_LIST;
+template<typename T>
+void DoublyLinkedArrayList<T>::storeData(T &dst, const T &src) const
+{
+    static_assert(std::is_trivially_copyable<T>::value && (sizeof(T) % sizeof(unsigned long long) == 0),
+                  "T must be copyable as whole words");
+
+    if (retireFunc == nullptr) {
+        dst = src;
+        return;
+    }
+
+    unsigned long long words[sizeof(T) / sizeof(unsigned long long)];
+    std::memcpy(words, &src, sizeof(T));
+
+    auto dstWords = reinterpret_cast<unsigned long long *>(&dst);
+    for (size_t w = 0; w < sizeof(T) / sizeof(*words); ++w) __atomic_store_n(&dstWords[w], words[w], __ATOMIC_RELEASE);
+}
+
+template<typename T>
+T DoublyLinkedArrayList<T>::loadData(const T &src)
+{
+    unsigned long long words[sizeof(T) / sizeof(unsigned long long)];
+
+    auto srcWords = reinterpret_cast<const unsigned long long *>(&src);
+    for (size_t w = 0; w < sizeof(T) / sizeof(*words); ++w) words[w] = __atomic_load_n(&srcWords[w], __ATOMIC_ACQUIRE);
+
+    T data;
+    std::memcpy(&data, words, sizeof(T));
+
+    return data;
+}
+
+template<typename T>
+void DoublyLinkedArrayList<T>::storeTag(unsigned char &dst, const unsigned char tag) const
+{
+    if (retireFunc == nullptr) {
+        dst = tag;
+        return;
+    }
+
+    __atomic_store_n(&dst, tag, __ATOMIC_RELAXED);
 }
 
 template<typename T>
@@ -564,10 +740,37 @@ void DoublyLinkedArrayList<T>::grow()
 {
     VALIDATE_LIST;
 
-    capacity *= growCoeff;
-    nodes = (Node *) std::realloc(nodes, sizeof(Node) * (capacity + 1));
+    size_t oldTagsSize = tagsSize(capacity);
 
-    createFreePosList(size + 1);
+    if (retireFunc == nullptr) {
+        capacity *= growCoeff;
+        nodes = (Node *) std::realloc(nodes, sizeof(Node) * (capacity + 1));
+        tags = (unsigned char *) std::realloc(tags, tagsSize(capacity));
+        std::memset(tags + oldTagsSize, 0, tagsSize(capacity) - oldTagsSize);
+
+        createFreePosList(size + 1);
+    } else {
+        size_t grownCapacity = capacity * growCoeff;
+        auto grownNodes = (Node *) std::malloc(sizeof(Node) * (grownCapacity + 1));
+        auto grownTags = (unsigned char *) std::malloc(tagsSize(grownCapacity));
+        std::memcpy(grownNodes, nodes, sizeof(Node) * (capacity + 1));
+        std::memcpy(grownTags, tags, oldTagsSize);
+        std::memset(grownTags + oldTagsSize, 0, tagsSize(grownCapacity) - oldTagsSize);
+        fillFreePositions(grownNodes, grownTags, size + 1, grownCapacity);
+
+        // Concurrent readers may pick up the new capacity as soon as it is stored,
+        // so the arrays must be fully initialized before they are published.
+        Node *oldNodes = nodes;
+        unsigned char *oldTags = tags;
+        size_t oldCapacity = capacity;
+        __atomic_store_n(&tags, grownTags, __ATOMIC_RELEASE);
+        __atomic_store_n(&nodes, grownNodes, __ATOMIC_RELEASE);
+        __atomic_store_n(&capacity, grownCapacity, __ATOMIC_RELEASE);
+        freeListHeadPos = size + 1;
+
+        retireFunc(retireCtx, oldNodes, sizeof(Node) * (oldCapacity + 1));
+        retireFunc(retireCtx, oldTags, oldTagsSize);
+    }
 
     VALIDATE_LIST;
 }
@@ -583,7 +786,7 @@ void DoublyLinkedArrayList<T>::validate() const
 
 template<typename T>
 DoublyLinkedArrayList<T>::DoublyLinkedArrayList()
-: DoublyLinkedArrayList(16)
+: DoublyLinkedArrayList(defaultCapacity)
 {
 }
 
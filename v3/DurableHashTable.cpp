@@ -0,0 +1,142 @@
+#include "DurableHashTable.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+DurableHashTable::DurableHashTable(unsigned long long (*const hashFunc)(const DurableHashTable::String &))
+: table_(hashFunc)
+{
+}
+
+DurableHashTable::~DurableHashTable()
+{
+    close();
+}
+
+bool DurableHashTable::open(const char *const snapshotPath, const char *const logPath, const unsigned commitWindowUs)
+{
+    close();
+
+    if ((access(snapshotPath, F_OK) == 0) && !table_.load(snapshotPath)) return false;
+    table_.thaw();
+
+    std::size_t validSize = 0;
+    if (!WriteAheadLog::replay(logPath, applyRecord, this, &validSize)) return false;
+    if ((access(logPath, F_OK) == 0) && (truncate(logPath, validSize) != 0)) return false;
+
+    if (!log_.open(logPath, commitWindowUs)) return false;
+
+    snapshotPath_ = strdup(snapshotPath);
+
+    return true;
+}
+
+void DurableHashTable::close()
+{
+    log_.close();
+
+    table_.clear();
+    keys_.clear();
+    vals_.clear();
+
+    std::free(snapshotPath_);
+    snapshotPath_ = nullptr;
+}
+
+void DurableHashTable::applyRecord(void *const ctx, const WriteAheadLog::RecordType type,
+                                   const DurableHashTable::String &key, const DurableHashTable::String &val)
+{
+    static_cast<DurableHashTable *>(ctx)->apply(type, key, val);
+}
+
+void DurableHashTable::apply(const WriteAheadLog::RecordType type, const DurableHashTable::String &key,
+                             const DurableHashTable::String &val)
+{
+    if (type == WriteAheadLog::Remove) {
+        table_.remove(key);
+    } else if (table_.find(key) == nullptr) {
+        table_.insert(keys_.add(key, strnlen(key, HashTable::StringSize - 1)),
+                      vals_.add(val, strnlen(val, HashTable::StringSize - 1)));
+    }
+}
+
+bool DurableHashTable::insert(const DurableHashTable::String &key, const DurableHashTable::String &val)
+{
+    if (table_.find(key) != nullptr) return false;
+    if (log_.logInsert(key, val) == 0) return false;
+
+    apply(WriteAheadLog::Insert, key, val);
+
+    return true;
+}
+
+bool DurableHashTable::remove(const DurableHashTable::String &key)
+{
+    if (table_.find(key) == nullptr) return false;
+    if (log_.logRemove(key) == 0) return false;
+
+    return table_.remove(key);
+}
+
+const DurableHashTable::String *DurableHashTable::find(const DurableHashTable::String &key) const
+{
+    return table_.find(key);
+}
+
+bool DurableHashTable::sync()
+{
+    return log_.sync();
+}
+
+bool DurableHashTable::checkpoint()
+{
+    if ((snapshotPath_ == nullptr) || !log_.sync()) return false;
+
+    const std::size_t pathLen = std::strlen(snapshotPath_);
+    auto tmpPath = static_cast<char *>(std::malloc(pathLen + sizeof(".tmp")));
+    std::memcpy(tmpPath, snapshotPath_, pathLen);
+    std::memcpy(tmpPath + pathLen, ".tmp", sizeof(".tmp"));
+
+    table_.freeze();
+    const bool saved = table_.save(tmpPath) && (std::rename(tmpPath, snapshotPath_) == 0);
+    table_.thaw();
+    std::free(tmpPath);
+
+    keys_.clear();
+    vals_.clear();
+
+    // The rename must be durable before the log is emptied, or a crash could pair the old snapshot with an empty log.
+    return saved && syncParentDir(snapshotPath_) && log_.truncate();
+}
+
+bool DurableHashTable::syncParentDir(const char *const path)
+{
+    const char *const slash = std::strrchr(path, '/');
+    const std::size_t dirLen = (slash == nullptr) ? 0 : ((slash == path) ? 1 : slash - path);
+
+    auto dirPath = static_cast<char *>(std::malloc(dirLen + sizeof(".")));
+    if (dirLen == 0) {
+        std::memcpy(dirPath, ".", sizeof("."));
+    } else {
+        std::memcpy(dirPath, path, dirLen);
+        dirPath[dirLen] = '\0';
+    }
+
+    const int fd = ::open(dirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    std::free(dirPath);
+    if (fd < 0) return false;
+
+    const bool synced = fsync(fd) == 0;
+    ::close(fd);
+
+    return synced;
+}
+
+const HashTable &DurableHashTable::table() const
+{
+    return table_;
+}
@@ -0,0 +1,47 @@
+#ifndef DURABLEHASHTABLE_HPP
+#define DURABLEHASHTABLE_HPP
+
+#include "HashTable.hpp"
+#include "KeyArena.hpp"
+#include "WriteAheadLog.hpp"
+
+class DurableHashTable {
+public:
+    typedef HashTable::String String;
+
+    DurableHashTable() = delete;
+    explicit DurableHashTable(unsigned long long (*hashFunc)(const String &));
+
+    DurableHashTable(const DurableHashTable &) = delete;
+    DurableHashTable &operator=(const DurableHashTable &) = delete;
+
+    ~DurableHashTable();
+
+    bool open(const char *snapshotPath, const char *logPath,
+              unsigned commitWindowUs = WriteAheadLog::DefaultCommitWindowUs);
+    void close();
+
+    bool insert(const String &key, const String &val);
+    bool remove(const String &key);
+    const String *find(const String &key) const;
+
+    bool sync();
+    bool checkpoint();
+
+    const HashTable &table() const;
+
+private:
+    static bool syncParentDir(const char *path);
+    static void applyRecord(void *ctx, WriteAheadLog::RecordType type, const String &key, const String &val);
+
+    void apply(WriteAheadLog::RecordType type, const String &key, const String &val);
+
+    HashTable table_;
+    KeyArena keys_;
+    KeyArena vals_;
+    WriteAheadLog log_;
+
+    char *snapshotPath_{};
+};
+
+#endif /* DURABLEHASHTABLE_HPP */
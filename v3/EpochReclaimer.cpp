@@ -0,0 +1,228 @@
+#include "EpochReclaimer.hpp"
+
+#include <cstdlib>
+
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <thread>
+
+EpochReclaimer::Guard::Guard()
+{
+    EpochReclaimer::instance().enter();
+}
+
+EpochReclaimer::Guard::~Guard()
+{
+    EpochReclaimer::instance().leave();
+}
+
+EpochReclaimer &EpochReclaimer::instance()
+{
+    static EpochReclaimer reclaimer;
+
+    return reclaimer;
+}
+
+EpochReclaimer::EpochReclaimer()
+: expeditedMembarrier_(syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0)
+{
+}
+
+EpochReclaimer::~EpochReclaimer()
+{
+    ThreadRecord *record = records_.load(std::memory_order_acquire);
+    while (record != nullptr) {
+        ThreadRecord *next = record->next;
+        freeExpired(record->retired, ~0ul, nullptr, nullptr, nullptr);
+        delete record;
+        record = next;
+    }
+
+    freeExpired(orphans_, ~0ul, nullptr, nullptr, nullptr);
+}
+
+EpochReclaimer::ThreadHandle::~ThreadHandle()
+{
+    if (record != nullptr) EpochReclaimer::instance().releaseRecord(record);
+}
+
+EpochReclaimer::ThreadRecord &EpochReclaimer::localRecord()
+{
+    static thread_local ThreadHandle handle;
+    if (handle.record == nullptr) handle.record = acquireRecord();
+
+    return *handle.record;
+}
+
+EpochReclaimer::ThreadRecord *EpochReclaimer::acquireRecord()
+{
+    for (ThreadRecord *record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        bool inUse = false;
+        if (record->inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire)) return record;
+    }
+
+    auto record = new ThreadRecord{};
+    record->inUse.store(true, std::memory_order_relaxed);
+
+    record->next = records_.load(std::memory_order_relaxed);
+    while (!records_.compare_exchange_weak(record->next, record, std::memory_order_release,
+                                           std::memory_order_relaxed));
+
+    return record;
+}
+
+void EpochReclaimer::releaseRecord(EpochReclaimer::ThreadRecord *const record)
+{
+    std::lock_guard<std::mutex> retiredLock(record->retiredMutex);
+    if (record->retired != nullptr) {
+        Retired *last = record->retired;
+        while (last->next != nullptr) last = last->next;
+
+        std::lock_guard<std::mutex> lock(orphansMutex_);
+        last->next = orphans_;
+        orphans_ = record->retired;
+    }
+
+    record->retired = nullptr;
+    record->nRetired = 0;
+    record->retiredBytes = 0;
+    record->nesting = 0;
+    record->epoch.store(0, std::memory_order_relaxed);
+    record->inUse.store(false, std::memory_order_release);
+}
+
+void EpochReclaimer::enter()
+{
+    ThreadRecord &record = localRecord();
+    if (record.nesting++ != 0) return;
+
+    record.epoch.store((epoch_.load(std::memory_order_relaxed) << 1) | Active, std::memory_order_relaxed);
+
+    if (expeditedMembarrier_) {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    } else {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+void EpochReclaimer::leave()
+{
+    ThreadRecord &record = localRecord();
+    if (--record.nesting != 0) return;
+
+    record.epoch.store(0, std::memory_order_release);
+}
+
+void EpochReclaimer::retire(void *const ptr, const std::size_t bytes, const void *const owner)
+{
+    ThreadRecord &record = localRecord();
+
+    bool due;
+    {
+        std::lock_guard<std::mutex> lock(record.retiredMutex);
+        record.retired = new Retired{.ptr = ptr, .bytes = bytes, .owner = owner,
+                                     .epoch = epoch_.load(std::memory_order_seq_cst), .next = record.retired};
+        record.retiredBytes += bytes;
+
+        // Retires can be rare (e.g. bucket grows), so a count threshold alone may never fire.
+        due = (++record.nRetired >= collectThreshold) || (record.retiredBytes >= collectBytesThreshold) ||
+              (std::chrono::steady_clock::now() - record.lastCollect >= collectInterval);
+    }
+
+    if (due) collect();
+}
+
+void EpochReclaimer::collect()
+{
+    ThreadRecord &record = localRecord();
+
+    tryAdvance();
+    const unsigned long currEpoch = epoch_.load(std::memory_order_acquire);
+
+    {
+        std::lock_guard<std::mutex> lock(record.retiredMutex);
+        record.retired = freeExpired(record.retired, currEpoch, nullptr, &record.nRetired, &record.retiredBytes);
+        record.lastCollect = std::chrono::steady_clock::now();
+    }
+
+    if (orphansMutex_.try_lock()) {
+        orphans_ = freeExpired(orphans_, currEpoch, nullptr, nullptr, nullptr);
+        orphansMutex_.unlock();
+    }
+}
+
+void EpochReclaimer::synchronize()
+{
+    const unsigned long target = epoch_.load(std::memory_order_acquire) + 2;
+    while (epoch_.load(std::memory_order_acquire) < target) {
+        if (!tryAdvance()) std::this_thread::yield();
+    }
+}
+
+void EpochReclaimer::reclaim(const void *const owner)
+{
+    synchronize();
+
+    for (ThreadRecord *record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        std::lock_guard<std::mutex> lock(record->retiredMutex);
+        record->retired = freeExpired(record->retired, ~0ul, owner, &record->nRetired, &record->retiredBytes);
+    }
+
+    std::lock_guard<std::mutex> lock(orphansMutex_);
+    orphans_ = freeExpired(orphans_, ~0ul, owner, nullptr, nullptr);
+}
+
+unsigned long EpochReclaimer::epoch() const
+{
+    return epoch_.load(std::memory_order_acquire);
+}
+
+void EpochReclaimer::heavyFence() const
+{
+    if (expeditedMembarrier_) {
+        syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+    } else {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+bool EpochReclaimer::tryAdvance()
+{
+    unsigned long currEpoch = epoch_.load(std::memory_order_acquire);
+
+    heavyFence();
+
+    for (ThreadRecord *record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        const unsigned long recordEpoch = record->epoch.load(std::memory_order_acquire);
+        if ((recordEpoch & Active) && ((recordEpoch >> 1) != currEpoch)) return false;
+    }
+
+    return epoch_.compare_exchange_strong(currEpoch, currEpoch + 1, std::memory_order_acq_rel);
+}
+
+EpochReclaimer::Retired *EpochReclaimer::freeExpired(EpochReclaimer::Retired *retired, const unsigned long currEpoch,
+                                                     const void *const owner, std::size_t *const nRetired,
+                                                     std::size_t *const retiredBytes)
+{
+    Retired *kept = nullptr;
+    while (retired != nullptr) {
+        Retired *next = retired->next;
+
+        const bool owned = (owner == nullptr) || (retired->owner == owner);
+        if (owned && ((currEpoch == ~0ul) || (retired->epoch + 2 <= currEpoch))) {
+            if (nRetired != nullptr) --*nRetired;
+            if (retiredBytes != nullptr) *retiredBytes -= retired->bytes;
+            std::free(retired->ptr);
+            delete retired;
+        } else {
+            retired->next = kept;
+            kept = retired;
+        }
+
+        retired = next;
+    }
+
+    return kept;
+}
@@ -0,0 +1,92 @@
+#ifndef EPOCHRECLAIMER_HPP
+#define EPOCHRECLAIMER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+class EpochReclaimer {
+public:
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+    };
+
+    static EpochReclaimer &instance();
+
+    EpochReclaimer(const EpochReclaimer &) = delete;
+    EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+    void enter();
+    void leave();
+
+    void retire(void *ptr, std::size_t bytes = 0, const void *owner = nullptr);
+    void collect();
+
+    // Both wait for a full grace period, so they must not be called under a Guard.
+    void synchronize();
+    void reclaim(const void *owner);
+
+    unsigned long epoch() const;
+
+private:
+    struct Retired {
+        void *ptr;
+        std::size_t bytes;
+        const void *owner;
+        unsigned long epoch;
+        Retired *next;
+    };
+
+    struct alignas(64) ThreadRecord {
+        std::atomic<unsigned long> epoch{0};
+        std::atomic<bool> inUse{false};
+        ThreadRecord *next{};
+
+        std::size_t nesting{};
+
+        std::mutex retiredMutex;
+        Retired *retired{};
+        std::size_t nRetired{};
+        std::size_t retiredBytes{};
+        std::chrono::steady_clock::time_point lastCollect{};
+    };
+
+    struct ThreadHandle {
+        ~ThreadHandle();
+
+        ThreadRecord *record{};
+    };
+
+    static const unsigned long Active = 1;
+    static const std::size_t collectThreshold = 64;
+    static const std::size_t collectBytesThreshold = 1 << 20;
+    static constexpr std::chrono::milliseconds collectInterval{100};
+
+    EpochReclaimer();
+    ~EpochReclaimer();
+
+    ThreadRecord &localRecord();
+    ThreadRecord *acquireRecord();
+    void releaseRecord(ThreadRecord *record);
+
+    void heavyFence() const;
+    bool tryAdvance();
+    static Retired *freeExpired(Retired *retired, unsigned long currEpoch, const void *owner, std::size_t *nRetired,
+                                std::size_t *retiredBytes);
+
+    alignas(64) std::atomic<unsigned long> epoch_{0};
+    std::atomic<ThreadRecord *> records_{nullptr};
+
+    std::mutex orphansMutex_;
+    Retired *orphans_{};
+
+    bool expeditedMembarrier_;
+};
+
+#endif /* EPOCHRECLAIMER_HPP */
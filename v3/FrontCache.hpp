@@ -0,0 +1,174 @@
+#ifndef FRONTCACHE_HPP
+#define FRONTCACHE_HPP
+
+#include <cstdlib>
+#include <cstring>
+
+template<typename T>
+class FrontCache {
+public:
+    static const size_t nWays = 2;
+
+    FrontCache() = delete;
+    explicit FrontCache(size_t nSets);
+
+    FrontCache(const FrontCache<T> &) = delete;
+    FrontCache<T> &operator=(const FrontCache<T> &) = delete;
+
+    ~FrontCache();
+
+    const T *lookUp(unsigned long long hash, const T &val);
+    void insert(unsigned long long hash, const T &val);
+    void invalidate(unsigned long long hash, const T &val);
+    void clear();
+
+    // The state of the table the cached entries were read from.
+    size_t generation() const;
+    void setGeneration(size_t generation);
+
+    size_t hits() const;
+    size_t misses() const;
+    void resetCounters();
+
+    size_t capacity() const;
+    size_t memoryUsage() const;
+
+private:
+    struct Line {
+        unsigned long long hash;
+        T data;
+    };
+
+    struct alignas(64) Set {
+        Line ways[nWays];
+        size_t lruWay;
+    };
+
+    Set *sets;
+    size_t setMask;
+    size_t tableGeneration{};
+
+    size_t nHits{};
+    size_t nMisses{};
+
+    Set &setOf(unsigned long long hash) const;
+};
+
+template<typename T>
+FrontCache<T>::FrontCache(size_t nSets)
+: sets(nullptr), setMask(0)
+{
+    size_t nSetsPow2 = 1;
+    while (nSetsPow2 < nSets) nSetsPow2 <<= 1;
+
+    sets = (Set *) std::aligned_alloc(alignof(Set), nSetsPow2 * sizeof(*sets));
+    setMask = nSetsPow2 - 1;
+
+    clear();
+}
+
+template<typename T>
+FrontCache<T>::~FrontCache()
+{
+    std::free(sets);
+}
+
+template<typename T>
+typename FrontCache<T>::Set &FrontCache<T>::setOf(unsigned long long hash) const
+{
+    return sets[hash & setMask];
+}
+
+template<typename T>
+const T *FrontCache<T>::lookUp(unsigned long long hash, const T &val)
+{
+    Set &set = setOf(hash);
+
+    for (size_t way = 0; way < nWays; ++way) {
+        if ((set.ways[way].hash == hash) && (set.ways[way].data == val)) {
+            set.lruWay = way ^ 1;
+            ++nHits;
+
+            return &set.ways[way].data;
+        }
+    }
+
+    ++nMisses;
+
+    return nullptr;
+}
+
+template<typename T>
+void FrontCache<T>::insert(unsigned long long hash, const T &val)
+{
+    Set &set = setOf(hash);
+
+    size_t way = set.lruWay;
+    set.ways[way].hash = hash;
+    set.ways[way].data = val;
+    set.lruWay = way ^ 1;
+}
+
+template<typename T>
+void FrontCache<T>::invalidate(unsigned long long hash, const T &val)
+{
+    Set &set = setOf(hash);
+
+    for (size_t way = 0; way < nWays; ++way) {
+        if ((set.ways[way].hash == hash) && (set.ways[way].data == val)) {
+            std::memset(&set.ways[way], 0, sizeof(set.ways[way]));
+            set.lruWay = way;
+        }
+    }
+}
+
+template<typename T>
+void FrontCache<T>::clear()
+{
+    std::memset(sets, 0, (setMask + 1) * sizeof(*sets));
+}
+
+template<typename T>
+size_t FrontCache<T>::generation() const
+{
+    return tableGeneration;
+}
+
+template<typename T>
+void FrontCache<T>::setGeneration(size_t generation)
+{
+    tableGeneration = generation;
+}
+
+template<typename T>
+size_t FrontCache<T>::hits() const
+{
+    return nHits;
+}
+
+template<typename T>
+size_t FrontCache<T>::misses() const
+{
+    return nMisses;
+}
+
+template<typename T>
+void FrontCache<T>::resetCounters()
+{
+    nHits = 0;
+    nMisses = 0;
+}
+
+template<typename T>
+size_t FrontCache<T>::capacity() const
+{
+    return (setMask + 1) * nWays;
+}
+
+template<typename T>
+size_t FrontCache<T>::memoryUsage() const
+{
+    return (setMask + 1) * sizeof(*sets);
+}
+
+#endif /* FRONTCACHE_HPP */
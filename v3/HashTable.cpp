@@ -1,57 +1,707 @@
 #include "HashTable.hpp"
 
 #include <climits>
+#include <cstdlib>
 #include <immintrin.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <thread>
+
+#include "WorkStealingPool.hpp"
+
 HashTable::HashTable(unsigned long long (*const hashFunc)(const HashTable::String &))
 : hashFunc_(hashFunc), arr_{}
 {
 }
 
-std::size_t HashTable::hashFuncModulusWrapper(const HashTable::String &str) const
+HashTable::~HashTable()
+{
+    delete bloomFilter_;
+
+    releaseFrozen();
+}
+
+std::size_t HashTable::hashFuncModulusWrapper(const unsigned long long hash) const
 {
-    return hashFunc_(str) % sz_;
+    return hash % sz_;
 }
 
-void HashTable::insert(const HashTable::Entry &entry)
+bool HashTable::insert(const HashTable::Entry &entry)
 {
-    insert(*entry.key, *entry.val);
+    return insert(*entry.key, *entry.val);
 }
 
-void HashTable::insert(const HashTable::String &key, const HashTable::String &val)
+bool HashTable::insert(const HashTable::String &key, const HashTable::String &val)
 {
-    DoublyLinkedArrayList<HashTable::Entry> &list = arr_[hashFuncModulusWrapper(key)];
+    if (frozen_ != nullptr) return false;
 
+    const unsigned long long hash = hashFunc_(key);
     Entry entry{.key = &key, .val = &val};
-    auto node = list.findNodeByValue(entry);
-    if (node != nullptr) return;
+    if (!insertHashed(entry, hash)) return false;
+
+    if (bloomFilter_ != nullptr) bloomFilter_->insert(hash);
+    ++generation_;
 
-    list.insertAfterHead(entry);
+    return true;
+}
+
+void HashTable::insert(const HashTable::Entry entries[], const std::size_t n, const unsigned nThreads)
+{
+    if (frozen_ != nullptr) return;
+
+    if (nThreads <= 1) {
+        for (std::size_t i = 0; i < n; ++i) insert(entries[i]);
+        return;
+    }
+
+    auto hashes = new unsigned long long[n];
+    auto partitionCnts = new std::size_t[nThreads * nThreads]{};
+    auto scattered = new std::size_t[n];
+    auto threads = new std::thread[nThreads];
+
+    auto partitionOf = [nThreads](std::size_t bucket) { return bucket * nThreads / sz_; };
+    auto sliceBegin = [n, nThreads](unsigned thread) { return n * thread / nThreads; };
+
+    for (unsigned t = 0; t < nThreads; ++t) {
+        threads[t] = std::thread([&, t] {
+            for (std::size_t i = sliceBegin(t); i < sliceBegin(t + 1); ++i) {
+                hashes[i] = hashFunc_(*entries[i].key);
+                ++partitionCnts[t * nThreads + partitionOf(hashFuncModulusWrapper(hashes[i]))];
+            }
+        });
+    }
+    for (unsigned t = 0; t < nThreads; ++t) threads[t].join();
+
+    auto partitionStarts = new std::size_t[nThreads + 1]{};
+    for (std::size_t p = 0, offset = 0; p < nThreads; ++p) {
+        partitionStarts[p] = offset;
+        for (std::size_t t = 0; t < nThreads; ++t) {
+            std::size_t cnt = partitionCnts[t * nThreads + p];
+            partitionCnts[t * nThreads + p] = offset;
+            offset += cnt;
+        }
+    }
+    partitionStarts[nThreads] = n;
+
+    for (unsigned t = 0; t < nThreads; ++t) {
+        threads[t] = std::thread([&, t] {
+            for (std::size_t i = sliceBegin(t); i < sliceBegin(t + 1); ++i) {
+                scattered[partitionCnts[t * nThreads + partitionOf(hashFuncModulusWrapper(hashes[i]))]++] = i;
+            }
+        });
+    }
+    for (unsigned t = 0; t < nThreads; ++t) threads[t].join();
+
+    for (unsigned p = 0; p < nThreads; ++p) {
+        threads[p] = std::thread([&, p] {
+            for (std::size_t j = partitionStarts[p]; j < partitionStarts[p + 1]; ++j) {
+                insertHashed(entries[scattered[j]], hashes[scattered[j]]);
+            }
+        });
+    }
+    for (unsigned p = 0; p < nThreads; ++p) threads[p].join();
+
+    delete[] partitionStarts;
+    delete[] threads;
+    delete[] scattered;
+    delete[] partitionCnts;
+    delete[] hashes;
+
+    if (bloomFilter_ != nullptr) rebuildBloomFilter();
+    ++generation_;
+}
+
+bool HashTable::insertHashed(const HashTable::Entry &entry, const unsigned long long hash)
+{
+    DoublyLinkedArrayList<HashTable::Entry> &list = arr_[hashFuncModulusWrapper(hash)];
+
+    const unsigned char tag = tagOf(hash);
+    if (list.findNodeByValue(entry, tag) != nullptr) return false;
+
+    list.insertAfterHead(entry, tag);
+
+    return true;
 }
 
 bool HashTable::remove(const HashTable::String &key)
 {
-    auto &list = arr_[hashFuncModulusWrapper(key)];
+    if (frozen_ != nullptr) return false;
 
-    auto node = list.findNodeByValue(Entry{.key = &key, .val = nullptr});
+    const unsigned long long hash = hashFunc_(key);
+    auto &list = arr_[hashFuncModulusWrapper(hash)];
+
+    Entry entry{.key = &key, .val = nullptr};
+    auto node = list.findNodeByValue(entry, tagOf(hash));
     if (node == nullptr) return false;
 
     list.deleteFromPhysicalPos(node->curr);
 
+    ++generation_;
+    if ((bloomFilter_ != nullptr) && (++nRemovedSinceRebuild_ > bloomFilter_->capacity() / 4)) rebuildBloomFilter();
+
     return true;
 }
 
 const HashTable::String *HashTable::find(const HashTable::String &key) const
 {
-    auto node = arr_[hashFuncModulusWrapper(key)].findNodeByValue(Entry{.key = &key, .val = nullptr});
-    if (node == nullptr) return nullptr;
+    return findHashed(Entry{.key = &key, .val = nullptr}, hashFunc_(key)).val;
+}
+
+const HashTable::String *HashTable::find(const HashTable::String &key, FrontCache<HashTable::Entry> &cache) const
+{
+    const unsigned long long hash = hashFunc_(key);
+    Entry entry{.key = &key, .val = nullptr};
+
+    if (cache.generation() != generation_) {
+        cache.clear();
+        cache.setGeneration(generation_);
+    }
+
+    auto cached = cache.lookUp(hash, entry);
+    if (cached != nullptr) return cached->val;
+
+    Entry found = findHashed(entry, hash);
+    if (found.key == nullptr) return nullptr;
+
+    if ((frozen_ == nullptr) || (frozen_->frontCoded == nullptr)) cache.insert(hash, found);
+
+    return found.val;
+}
+
+void HashTable::findBatch(const HashTable::String *const keys[], const std::size_t n,
+                          const HashTable::String *vals[]) const
+{
+    unsigned long long hashes[BatchGroup];
+
+    for (std::size_t base = 0; base < n; base += BatchGroup) {
+        const std::size_t groupSize = (n - base < BatchGroup) ? n - base : BatchGroup;
+
+        for (std::size_t j = 0; j < groupSize; ++j) {
+            hashes[j] = hashFunc_(*keys[base + j]);
+            prefetchBucket(hashes[j]);
+        }
+
+        // By now the first bucket headers have arrived, so their tag arrays can be requested.
+        for (std::size_t j = 0; j < groupSize; ++j) prefetchTags(hashes[j]);
+
+        for (std::size_t j = 0; j < groupSize; ++j) {
+            vals[base + j] = findHashed(Entry{.key = keys[base + j], .val = nullptr}, hashes[j]).val;
+        }
+    }
+}
+
+void HashTable::findBatch(const HashTable::String *const keys[], const std::size_t n, const HashTable::String *vals[],
+                          WorkStealingPool &pool) const
+{
+    BatchCtx ctx{.table = this, .keys = keys, .vals = vals};
 
-    return node->data.val;
+    pool.parallelFor(n, BatchGrain, findBatchTask, &ctx);
+}
+
+void HashTable::findBatchTask(void *const ctx, const std::size_t begin, const std::size_t end)
+{
+    const BatchCtx &batch = *static_cast<const BatchCtx *>(ctx);
+
+    batch.table->findBatch(batch.keys + begin, end - begin, batch.vals + begin);
+}
+
+HashTable::Entry HashTable::findHashed(const HashTable::Entry &entry, const unsigned long long hash) const
+{
+    if ((bloomFilter_ != nullptr) && !bloomFilter_->mayContain(hash)) return Entry{.key = nullptr, .val = nullptr};
+
+    if (frozen_ != nullptr) return findFrozen(entry, hash);
+
+    auto node = arr_[hashFuncModulusWrapper(hash)].findNodeByValue(entry, tagOf(hash));
+    if (node == nullptr) return Entry{.key = nullptr, .val = nullptr};
+
+    return node->data;
+}
+
+void HashTable::prefetchBucket(const unsigned long long hash) const
+{
+    const std::size_t bucket = hashFuncModulusWrapper(hash);
+
+    if ((frozen_ != nullptr) && (frozen_->frontCoded != nullptr)) {
+        const FrontCodedKeys &frontCoded = *frozen_->frontCoded;
+        _mm_prefetch(reinterpret_cast<const char *>(frontCoded.blockWords + frontCoded.bucketBlocks[bucket]), _MM_HINT_T0);
+    } else if (frozen_ != nullptr) {
+        const std::size_t offset = frozen_->offsets[bucket];
+        _mm_prefetch(reinterpret_cast<const char *>(frozen_->tags + offset), _MM_HINT_T0);
+        _mm_prefetch(reinterpret_cast<const char *>(frozen_->keys + offset), _MM_HINT_T0);
+    } else {
+        _mm_prefetch(reinterpret_cast<const char *>(&arr_[bucket]), _MM_HINT_T0);
+    }
+}
+
+void HashTable::prefetchTags(const unsigned long long hash) const
+{
+    // The frozen layouts already prefetch their tags in prefetchBucket().
+    if (frozen_ == nullptr) arr_[hashFuncModulusWrapper(hash)].prefetchTags();
+}
+
+HashTable::Entry HashTable::findFrozen(const HashTable::Entry &entry, const unsigned long long hash) const
+{
+    if (frozen_->frontCoded != nullptr) return findFrontCoded(entry, hash);
+
+    const std::size_t bucket = hashFuncModulusWrapper(hash);
+    const std::size_t end = frozen_->offsets[bucket + 1];
+    const unsigned char tag = tagOf(hash);
+
+    for (std::size_t base = frozen_->offsets[bucket]; base < end; base += TagBlockSize) {
+        unsigned matches = matchTags(frozen_->tags + base, tag);
+        if (end - base < TagBlockSize) matches &= (1u << (end - base)) - 1;
+
+        while (matches != 0) {
+            const std::size_t i = base + __builtin_ctz(matches);
+            Entry candidate{.key = &frozen_->keys[i], .val = &frozen_->vals[i]};
+            if (candidate == entry) return candidate;
+
+            matches &= matches - 1;
+        }
+    }
+
+    return Entry{.key = nullptr, .val = nullptr};
 }
 
 void HashTable::clear()
 {
     for (auto &list: arr_) list.clear();
+
+    releaseFrozen();
+
+    if (bloomFilter_ != nullptr) bloomFilter_->clear();
+    nRemovedSinceRebuild_ = 0;
+
+    ++generation_;
+}
+
+void HashTable::freeze(const bool frontCoded)
+{
+    if (frozen_ != nullptr) return;
+
+    if (frontCoded) {
+        freezeFrontCoded();
+        return;
+    }
+
+    std::size_t nEntries = 0;
+    for (auto &list: arr_) nEntries += list.size;
+
+    frozen_ = new FrozenBuckets{};
+    frozen_->offsets = new std::size_t[sz_ + 1];
+    frozen_->tags = static_cast<unsigned char *>(std::calloc(nEntries + TagBlockSize, sizeof(*frozen_->tags)));
+    frozen_->keys = static_cast<String *>(std::aligned_alloc(sizeof(String), (nEntries + 1) * sizeof(String)));
+    frozen_->vals = static_cast<String *>(std::aligned_alloc(sizeof(String), (nEntries + 1) * sizeof(String)));
+
+    std::size_t pos = 0;
+    for (std::size_t bucket = 0; bucket < sz_; ++bucket) {
+        auto &list = arr_[bucket];
+
+        frozen_->offsets[bucket] = pos;
+        for (auto node = list.tailNode(); node->curr != 0; node = list.nodeAfterPhysicalPos(node->curr), ++pos) {
+            std::memcpy(frozen_->keys[pos], *node->data.key, sizeof(String));
+            std::memcpy(frozen_->vals[pos], *node->data.val, sizeof(String));
+            frozen_->tags[pos] = tagOf(hashFunc_(*node->data.key));
+        }
+
+        list.clear();
+        list.shrinkToFit();
+    }
+    frozen_->offsets[sz_] = pos;
+    std::memset(frozen_->keys[pos], 0, sizeof(String));
+    std::memset(frozen_->vals[pos], 0, sizeof(String));
+
+    releaseThawed();
+
+    ++generation_;
+}
+
+bool HashTable::frozen() const
+{
+    return frozen_ != nullptr;
+}
+
+void HashTable::releaseFrozen()
+{
+    destroyFrozen(frozen_);
+    frozen_ = nullptr;
+
+    releaseThawed();
+}
+
+void HashTable::releaseThawed()
+{
+    destroyFrozen(thawed_);
+    thawed_ = nullptr;
+}
+
+void HashTable::destroyFrozen(HashTable::FrozenBuckets *const frozen)
+{
+    if (frozen == nullptr) return;
+
+    if (frozen->frontCoded != nullptr) {
+        std::free(frozen->frontCoded->bytes);
+        delete[] frozen->frontCoded->blockStarts;
+        delete[] frozen->frontCoded->bucketBlocks;
+        delete[] frozen->frontCoded->blockWords;
+        delete[] frozen->frontCoded->valIdxs;
+        std::free(frozen->frontCoded->valPool);
+        delete frozen->frontCoded;
+        delete[] frozen->offsets;
+    } else if (frozen->mapping != nullptr) {
+        munmap(frozen->mapping, frozen->mappingSize);
+    } else {
+        delete[] frozen->offsets;
+        std::free(frozen->tags);
+        std::free(frozen->keys);
+        std::free(frozen->vals);
+    }
+
+    delete frozen;
+}
+
+bool HashTable::thaw()
+{
+    if (frozen_ == nullptr) return true;
+    if (frozen_->frontCoded != nullptr) return false;
+
+    for (std::size_t bucket = 0; bucket < sz_; ++bucket) {
+        for (std::size_t i = frozen_->offsets[bucket]; i < frozen_->offsets[bucket + 1]; ++i) {
+            arr_[bucket].insertAfterHead(Entry{.key = &frozen_->keys[i], .val = &frozen_->vals[i]}, frozen_->tags[i]);
+        }
+    }
+
+    thawed_ = frozen_;
+    frozen_ = nullptr;
+
+    ++generation_;
+
+    return true;
+}
+
+unsigned long long HashTable::keyWord(const HashTable::String &key)
+{
+    return __builtin_bswap64(*reinterpret_cast<const unsigned long long *>(key));
+}
+
+int HashTable::compareKeys(const void *const arg1, const void *const arg2)
+{
+    return std::strncmp(*static_cast<const Entry *>(arg1)->key, *static_cast<const Entry *>(arg2)->key, StringSize);
+}
+
+int HashTable::compareVals(const void *const arg1, const void *const arg2)
+{
+    return std::memcmp(*static_cast<const String *const *>(arg1), *static_cast<const String *const *>(arg2),
+                       sizeof(String));
+}
+
+int HashTable::compareValToPool(const void *const arg1, const void *const arg2)
+{
+    return std::memcmp(*static_cast<const String *const *>(arg1), arg2, sizeof(String));
+}
+
+void HashTable::freezeFrontCoded()
+{
+    std::size_t nEntries = 0;
+    std::size_t maxBucketSize = 0;
+    std::size_t nBlocks = 0;
+    for (auto &list: arr_) {
+        nEntries += list.size;
+        nBlocks += (list.size + FrontCodedBlock - 1) / FrontCodedBlock;
+        if (list.size > maxBucketSize) maxBucketSize = list.size;
+    }
+
+    auto vals = new const String *[nEntries + 1];
+    std::size_t nVals = 0;
+    for (auto &list: arr_) {
+        for (auto node = list.tailNode(); node->curr != 0; node = list.nodeAfterPhysicalPos(node->curr)) {
+            vals[nVals++] = node->data.val;
+        }
+    }
+    std::qsort(vals, nVals, sizeof(*vals), compareVals);
+
+    auto frontCoded = new FrontCodedKeys{};
+    frontCoded->valPool = static_cast<String *>(std::aligned_alloc(sizeof(String), (nVals + 1) * sizeof(String)));
+    for (std::size_t i = 0; i < nVals; ++i) {
+        if ((frontCoded->nVals == 0) || (compareVals(&vals[i], &vals[i - 1]) != 0)) {
+            std::memcpy(frontCoded->valPool[frontCoded->nVals++], *vals[i], sizeof(String));
+        }
+    }
+    delete[] vals;
+
+    frontCoded->bytes = static_cast<unsigned char *>(std::malloc(nEntries * (2 + StringSize) + sizeof(unsigned long long)));
+    frontCoded->blockStarts = new std::size_t[nBlocks + 1];
+    frontCoded->bucketBlocks = new std::size_t[sz_ + 1];
+    frontCoded->blockWords = new unsigned long long[nBlocks + 1];
+    frontCoded->valIdxs = new unsigned[nEntries + 1];
+
+    frozen_ = new FrozenBuckets{};
+    frozen_->frontCoded = frontCoded;
+    frozen_->offsets = new std::size_t[sz_ + 1];
+
+    auto entries = new Entry[maxBucketSize + 1];
+    std::size_t pos = 0;
+    std::size_t block = 0;
+    std::size_t nBytes = 0;
+    for (std::size_t bucket = 0; bucket < sz_; ++bucket) {
+        auto &list = arr_[bucket];
+
+        std::size_t nBucketEntries = 0;
+        for (auto node = list.tailNode(); node->curr != 0; node = list.nodeAfterPhysicalPos(node->curr)) {
+            entries[nBucketEntries++] = node->data;
+        }
+        std::qsort(entries, nBucketEntries, sizeof(*entries), compareKeys);
+
+        frozen_->offsets[bucket] = pos;
+        frontCoded->bucketBlocks[bucket] = block;
+        for (std::size_t i = 0; i < nBucketEntries; ++i, ++pos) {
+            const char *const key = *entries[i].key;
+            const std::size_t keyLen = strnlen(key, StringSize - 1);
+
+            std::size_t prefixLen = 0;
+            if (i % FrontCodedBlock == 0) {
+                frontCoded->blockStarts[block] = nBytes;
+                frontCoded->blockWords[block++] = keyWord(*entries[i].key);
+            } else {
+                const char *const prev = *entries[i - 1].key;
+                while ((prefixLen < keyLen) && (key[prefixLen] == prev[prefixLen])) ++prefixLen;
+            }
+
+            frontCoded->bytes[nBytes++] = static_cast<unsigned char>(prefixLen);
+            frontCoded->bytes[nBytes++] = static_cast<unsigned char>(keyLen - prefixLen);
+            std::memcpy(frontCoded->bytes + nBytes, key + prefixLen, keyLen - prefixLen);
+            nBytes += keyLen - prefixLen;
+
+            auto val = static_cast<const String *>(std::bsearch(&entries[i].val, frontCoded->valPool,
+                                                                frontCoded->nVals, sizeof(String), compareValToPool));
+            frontCoded->valIdxs[pos] = static_cast<unsigned>(val - frontCoded->valPool);
+        }
+
+        list.clear();
+        list.shrinkToFit();
+    }
+    frozen_->offsets[sz_] = pos;
+    frontCoded->bucketBlocks[sz_] = block;
+    frontCoded->blockStarts[block] = nBytes;
+    frontCoded->bytes = static_cast<unsigned char *>(std::realloc(frontCoded->bytes, nBytes + sizeof(unsigned long long)));
+
+    delete[] entries;
+
+    releaseThawed();
+
+    ++generation_;
+}
+
+HashTable::Entry HashTable::findFrontCoded(const HashTable::Entry &entry, const unsigned long long hash) const
+{
+    const FrontCodedKeys &frontCoded = *frozen_->frontCoded;
+    const std::size_t bucket = hashFuncModulusWrapper(hash);
+    const unsigned long long needle = keyWord(*entry.key);
+
+    std::size_t lo = frontCoded.bucketBlocks[bucket];
+    std::size_t hi = frontCoded.bucketBlocks[bucket + 1];
+    if ((lo == hi) || (frontCoded.blockWords[lo] > needle)) return Entry{.key = nullptr, .val = nullptr};
+
+    const std::size_t firstBlock = lo;
+    while (hi - lo > 1) {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (frontCoded.blockWords[mid] <= needle) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    const unsigned char *pos = frontCoded.bytes + frontCoded.blockStarts[lo];
+    const unsigned char *const end = frontCoded.bytes + frontCoded.blockStarts[lo + 1];
+    std::size_t idx = frozen_->offsets[bucket] + (lo - firstBlock) * FrontCodedBlock;
+
+    const std::size_t wordSize = sizeof(unsigned long long);
+    auto topBytes = [](std::size_t n) { return (n == 0) ? 0 : ~0ull << (CHAR_BIT * (wordSize - n)); };
+
+    unsigned long long curr = 0;
+    for (; pos < end; ++idx) {
+        const std::size_t prefixLen = pos[0];
+        const std::size_t suffixLen = pos[1];
+        pos += 2;
+
+        if (prefixLen < wordSize) {
+            unsigned long long suffix;
+            std::memcpy(&suffix, pos, sizeof(suffix));
+            suffix = __builtin_bswap64(suffix) >> (CHAR_BIT * prefixLen);
+
+            const std::size_t wordLen = (prefixLen + suffixLen < wordSize) ? prefixLen + suffixLen : wordSize;
+            curr = (curr & topBytes(prefixLen)) | (suffix & topBytes(wordLen));
+        }
+        pos += suffixLen;
+
+        if (curr == needle) return Entry{.key = entry.key, .val = &frontCoded.valPool[frontCoded.valIdxs[idx]]};
+        if (curr > needle) break;
+    }
+
+    return Entry{.key = nullptr, .val = nullptr};
+}
+
+std::size_t HashTable::snapshotPadded(const std::size_t size)
+{
+    return (size + SnapshotAlign - 1) / SnapshotAlign * SnapshotAlign;
+}
+
+unsigned long long HashTable::snapshotChecksum(unsigned long long crc, const void *const data, const std::size_t size)
+{
+    auto bytes = static_cast<const unsigned char *>(data);
+
+    std::size_t i = 0;
+    for (; i + sizeof(unsigned long long) <= size; i += sizeof(unsigned long long)) {
+        unsigned long long word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        crc = _mm_crc32_u64(crc, word);
+    }
+    for (; i < size; ++i) crc = _mm_crc32_u8(static_cast<unsigned>(crc), bytes[i]);
+
+    return crc;
+}
+
+bool HashTable::save(const char *const path) const
+{
+    if ((frozen_ == nullptr) || (frozen_->frontCoded != nullptr)) return false;
+
+    const std::size_t nEntries = frozen_->offsets[sz_];
+    const void *const sections[] = {frozen_->offsets, frozen_->tags, frozen_->keys, frozen_->vals};
+    const std::size_t sizes[] = {(sz_ + 1) * sizeof(*frozen_->offsets), (nEntries + TagBlockSize) * sizeof(*frozen_->tags),
+                                 (nEntries + 1) * sizeof(String), (nEntries + 1) * sizeof(String)};
+    const unsigned char padding[SnapshotAlign]{};
+
+    SnapshotHeader header{.magic = {'H', 'T', 'S', 'N', 'A', 'P', '\0', '\0'}, .version = SnapshotVersion,
+                          .nBuckets = sz_, .nEntries = nEntries, .checksum = 0, .reserved = {}};
+    for (std::size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); ++s) {
+        header.checksum = snapshotChecksum(header.checksum, sections[s], sizes[s]);
+        header.checksum = snapshotChecksum(header.checksum, padding, snapshotPadded(sizes[s]) - sizes[s]);
+    }
+
+    std::FILE *stream = std::fopen(path, "wb");
+    if (stream == nullptr) return false;
+
+    bool written = std::fwrite(&header, sizeof(header), 1, stream) == 1;
+    for (std::size_t s = 0; written && (s < sizeof(sizes) / sizeof(*sizes)); ++s) {
+        const std::size_t nPadding = snapshotPadded(sizes[s]) - sizes[s];
+        written = (std::fwrite(sections[s], 1, sizes[s], stream) == sizes[s]) &&
+                  (std::fwrite(padding, 1, nPadding, stream) == nPadding);
+    }
+
+    written = written && (std::fflush(stream) == 0) && (fsync(fileno(stream)) == 0);
+
+    return (std::fclose(stream) == 0) && written;
+}
+
+bool HashTable::load(const char *const path, const bool verify)
+{
+    clear();
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat buf{};
+    void *mapping = MAP_FAILED;
+    const std::size_t mappingSize = (fstat(fd, &buf) == 0) ? buf.st_size : 0;
+    if (mappingSize >= sizeof(SnapshotHeader)) {
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    auto base = static_cast<unsigned char *>(mapping);
+    const auto &header = *static_cast<const SnapshotHeader *>(mapping);
+    const std::size_t nEntries = header.nEntries;
+
+    const std::size_t offsetsPos = snapshotPadded(sizeof(SnapshotHeader));
+    const std::size_t tagsPos = offsetsPos + snapshotPadded((sz_ + 1) * sizeof(std::size_t));
+    const std::size_t keysPos = tagsPos + snapshotPadded((nEntries + TagBlockSize) * sizeof(unsigned char));
+    const std::size_t valsPos = keysPos + (nEntries + 1) * sizeof(String);
+    const std::size_t endPos = valsPos + (nEntries + 1) * sizeof(String);
+
+    bool valid = (std::memcmp(header.magic, "HTSNAP", 6) == 0) && (header.version == SnapshotVersion) &&
+                 (header.nBuckets == sz_) && (nEntries < mappingSize) && (endPos == mappingSize);
+    if (valid && verify) valid = snapshotChecksum(0, base + offsetsPos, endPos - offsetsPos) == header.checksum;
+
+    if (valid) {
+        frozen_ = new FrozenBuckets{};
+        frozen_->offsets = reinterpret_cast<std::size_t *>(base + offsetsPos);
+        frozen_->tags = base + tagsPos;
+        frozen_->keys = reinterpret_cast<String *>(base + keysPos);
+        frozen_->vals = reinterpret_cast<String *>(base + valsPos);
+        frozen_->mapping = mapping;
+        frozen_->mappingSize = mappingSize;
+
+        valid = (frozen_->offsets[0] == 0) && (frozen_->offsets[sz_] == nEntries) &&
+                ((nEntries == 0) || (frozen_->tags[0] == tagOf(hashFunc_(frozen_->keys[0]))));
+        for (std::size_t bucket = 0; valid && (bucket < sz_); ++bucket) {
+            valid = frozen_->offsets[bucket] <= frozen_->offsets[bucket + 1];
+        }
+    }
+
+    if (!valid) {
+        if (frozen_ == nullptr) munmap(mapping, mappingSize);
+        releaseFrozen();
+        return false;
+    }
+
+    if (bloomFilter_ != nullptr) rebuildBloomFilter();
+
+    return true;
+}
+
+void HashTable::enableBloomFilter(const std::size_t capacity, const double falsePositiveRate)
+{
+    delete bloomFilter_;
+    bloomFilter_ = new BloomFilter{capacity, falsePositiveRate};
+
+    rebuildBloomFilter();
+}
+
+void HashTable::disableBloomFilter()
+{
+    delete bloomFilter_;
+    bloomFilter_ = nullptr;
+}
+
+const BloomFilter *HashTable::bloomFilter() const
+{
+    return bloomFilter_;
+}
+
+void HashTable::rebuildBloomFilter()
+{
+    bloomFilter_->clear();
+    nRemovedSinceRebuild_ = 0;
+
+    if ((frozen_ != nullptr) && (frozen_->frontCoded != nullptr)) {
+        const FrontCodedKeys &frontCoded = *frozen_->frontCoded;
+        const std::size_t nBlocks = frontCoded.bucketBlocks[sz_];
+
+        String key{};
+        for (const unsigned char *pos = frontCoded.bytes; pos < frontCoded.bytes + frontCoded.blockStarts[nBlocks];) {
+            const std::size_t prefixLen = pos[0];
+            const std::size_t suffixLen = pos[1];
+            std::memcpy(key + prefixLen, pos + 2, suffixLen);
+            std::memset(key + prefixLen + suffixLen, 0, sizeof(String) - prefixLen - suffixLen);
+            pos += 2 + suffixLen;
+
+            bloomFilter_->insert(hashFunc_(key));
+        }
+    } else if (frozen_ != nullptr) {
+        for (std::size_t i = 0; i < frozen_->offsets[sz_]; ++i) bloomFilter_->insert(hashFunc_(frozen_->keys[i]));
+    }
+
+    for (auto &list: arr_) {
+        for (auto node = list.tailNode(); node->curr != 0; node = list.nodeAfterPhysicalPos(node->curr)) {
+            bloomFilter_->insert(hashFunc_(*node->data.key));
+        }
+    }
 }
 
 void HashTable::validate() const
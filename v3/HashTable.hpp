@@ -4,7 +4,11 @@
 #include <cstring>
 #include <climits>
 
+#include "BloomFilter.hpp"
 #include "DoublyLinkedArrayList.hpp"
+#include "FrontCache.hpp"
+
+class WorkStealingPool;
 
 class HashTable {
 public:
@@ -26,22 +30,122 @@ public:
     HashTable() = delete;
     explicit HashTable(unsigned long long (*hashFunc)(const String &));
 
+    HashTable(const HashTable &) = delete;
+    HashTable &operator=(const HashTable &) = delete;
+
+    ~HashTable();
+
     void validate() const;
 
-    void insert(const Entry &entry);
-    void insert(const String &key, const String &val);
+    // Returns false if the key is already present or the table is frozen.
+    bool insert(const Entry &entry);
+    bool insert(const String &key, const String &val);
+    void insert(const Entry entries[], std::size_t n, unsigned nThreads);
     bool remove(const String &key);
     const String *find(const String &key) const;
+    // The cache belongs to the calling thread, so concurrent readers each bring their own. Any change to the table
+    // empties it on its next use; one cache should serve only one table.
+    const String *find(const String &key, FrontCache<Entry> &cache) const;
+    void findBatch(const String *const keys[], std::size_t n, const String *vals[]) const;
+    void findBatch(const String *const keys[], std::size_t n, const String *vals[], WorkStealingPool &pool) const;
 
     void clear();
 
+    void freeze(bool frontCoded = false);
+    bool thaw();
+    bool frozen() const;
+
+    bool save(const char *path) const;
+    bool load(const char *path, bool verify = true);
+
+    void enableBloomFilter(std::size_t capacity, double falsePositiveRate);
+    void disableBloomFilter();
+    const BloomFilter *bloomFilter() const;
+
 private:
-    std::size_t hashFuncModulusWrapper(const String &str) const;
+    struct FrontCodedKeys {
+        unsigned char *bytes;
+        std::size_t *blockStarts;
+        std::size_t *bucketBlocks;
+        unsigned long long *blockWords;
+        unsigned *valIdxs;
+        String *valPool;
+        std::size_t nVals;
+    };
+
+    struct FrozenBuckets {
+        FrontCodedKeys *frontCoded;
+
+        std::size_t *offsets;
+        unsigned char *tags;
+        String *keys;
+        String *vals;
+
+        void *mapping;
+        std::size_t mappingSize;
+    };
+
+    struct SnapshotHeader {
+        char magic[8];
+        unsigned long long version;
+        unsigned long long nBuckets;
+        unsigned long long nEntries;
+        unsigned long long checksum;
+        unsigned long long reserved[3];
+    };
+
+    static const std::size_t FrontCodedBlock = 16;
+
+    static const unsigned long long SnapshotVersion = 1;
+    static const std::size_t SnapshotAlign = 64;
+
+    struct BatchCtx {
+        const HashTable *table;
+        const String *const *keys;
+        const String **vals;
+    };
+
+    std::size_t hashFuncModulusWrapper(unsigned long long hash) const;
+
+    static const std::size_t BatchGroup = 16;
+    static const std::size_t BatchGrain = 1024;
+
+    bool insertHashed(const Entry &entry, unsigned long long hash);
+    Entry findHashed(const Entry &entry, unsigned long long hash) const;
+    void prefetchBucket(unsigned long long hash) const;
+    void prefetchTags(unsigned long long hash) const;
+    static void findBatchTask(void *ctx, std::size_t begin, std::size_t end);
+
+    Entry findFrozen(const Entry &entry, unsigned long long hash) const;
+    void releaseFrozen();
+    void releaseThawed();
+    static void destroyFrozen(FrozenBuckets *frozen);
+
+    void freezeFrontCoded();
+    Entry findFrontCoded(const Entry &entry, unsigned long long hash) const;
+    static int compareKeys(const void *arg1, const void *arg2);
+    static int compareVals(const void *arg1, const void *arg2);
+    static int compareValToPool(const void *arg1, const void *arg2);
+    static unsigned long long keyWord(const String &key);
+
+    static std::size_t snapshotPadded(std::size_t size);
+    static unsigned long long snapshotChecksum(unsigned long long crc, const void *data, std::size_t size);
+
+    void rebuildBloomFilter();
 
     static const std::size_t sz_ = 1009;
     DoublyLinkedArrayList<Entry> arr_[sz_];
 
     unsigned long long (*hashFunc_)(const String &);
+
+    BloomFilter *bloomFilter_{};
+    std::size_t nRemovedSinceRebuild_{};
+
+    // Bumped by every change that can stale a cached entry; see find(key, cache).
+    std::size_t generation_{};
+
+    FrozenBuckets *frozen_{};
+    FrozenBuckets *thawed_{};
 };
 
 std::size_t elfHash(const char *str);
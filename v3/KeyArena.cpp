@@ -0,0 +1,87 @@
+#include "KeyArena.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+KeyArena::KeyArena(const std::size_t chunkKeys)
+: chunkKeys_((chunkKeys == 0) ? 1 : chunkKeys)
+{
+}
+
+KeyArena::~KeyArena()
+{
+    clear();
+}
+
+void KeyArena::addChunk(const std::size_t nKeys)
+{
+    if (nChunks_ == chunksCap_) {
+        chunksCap_ = (chunksCap_ == 0) ? 16 : chunksCap_ * 2;
+        chunks_ = static_cast<String **>(std::realloc(chunks_, chunksCap_ * sizeof(*chunks_)));
+    }
+
+    curr_ = static_cast<String *>(std::aligned_alloc(sizeof(String), nKeys * sizeof(String)));
+    currUsed_ = 0;
+    currCap_ = nKeys;
+
+    chunks_[nChunks_++] = curr_;
+    nAllocated_ += nKeys;
+}
+
+KeyArena::String *KeyArena::allocate(const std::size_t n)
+{
+    if (n == 0) return nullptr;
+
+    if (currCap_ - currUsed_ < n) addChunk((n > chunkKeys_) ? n : chunkKeys_);
+
+    String *keys = curr_ + currUsed_;
+    currUsed_ += n;
+    nKeys_ += n;
+
+    return keys;
+}
+
+void KeyArena::release(std::size_t n)
+{
+    if (n > currUsed_) n = currUsed_;
+
+    currUsed_ -= n;
+    nKeys_ -= n;
+}
+
+const KeyArena::String &KeyArena::add(const char *const src, const std::size_t len)
+{
+    String &key = *allocate(1);
+
+    std::memset(key, 0, sizeof(String));
+    std::memcpy(key, src, (len > HashTable::StringSize - 1) ? HashTable::StringSize - 1 : len);
+
+    return key;
+}
+
+void KeyArena::clear()
+{
+    for (std::size_t c = 0; c < nChunks_; ++c) std::free(chunks_[c]);
+    std::free(chunks_);
+
+    chunks_ = nullptr;
+    nChunks_ = 0;
+    chunksCap_ = 0;
+
+    curr_ = nullptr;
+    currUsed_ = 0;
+    currCap_ = 0;
+
+    nKeys_ = 0;
+    nAllocated_ = 0;
+}
+
+std::size_t KeyArena::size() const
+{
+    return nKeys_;
+}
+
+std::size_t KeyArena::memoryUsage() const
+{
+    return nAllocated_ * sizeof(String) + chunksCap_ * sizeof(*chunks_);
+}
@@ -0,0 +1,46 @@
+#ifndef KEYARENA_HPP
+#define KEYARENA_HPP
+
+#include <cstddef>
+
+#include "HashTable.hpp"
+
+class KeyArena {
+public:
+    typedef HashTable::String String;
+
+    static const std::size_t DefaultChunkKeys = 4096;
+
+    explicit KeyArena(std::size_t chunkKeys = DefaultChunkKeys);
+
+    KeyArena(const KeyArena &) = delete;
+    KeyArena &operator=(const KeyArena &) = delete;
+
+    ~KeyArena();
+
+    String *allocate(std::size_t n);
+    // Hands back the last n keys of the latest allocate(); they must not be referenced afterwards.
+    void release(std::size_t n);
+    const String &add(const char *src, std::size_t len);
+    void clear();
+
+    std::size_t size() const;
+    std::size_t memoryUsage() const;
+
+private:
+    void addChunk(std::size_t nKeys);
+
+    String **chunks_{};
+    std::size_t nChunks_{};
+    std::size_t chunksCap_{};
+
+    String *curr_{};
+    std::size_t currUsed_{};
+    std::size_t currCap_{};
+
+    std::size_t chunkKeys_;
+    std::size_t nKeys_{};
+    std::size_t nAllocated_{};
+};
+
+#endif /* KEYARENA_HPP */
@@ -0,0 +1,100 @@
+#include "LineSplitter.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <immintrin.h>
+
+LineSplitter::~LineSplitter()
+{
+    clear();
+}
+
+void LineSplitter::pushLine(const std::size_t offset, const std::size_t length)
+{
+    if (nLines_ == cap_) {
+        cap_ = (cap_ == 0) ? 1024 : cap_ * 2;
+        offsets_ = static_cast<std::size_t *>(std::realloc(offsets_, cap_ * sizeof(*offsets_)));
+        lengths_ = static_cast<std::size_t *>(std::realloc(lengths_, cap_ * sizeof(*lengths_)));
+    }
+
+    offsets_[nLines_] = offset;
+    lengths_[nLines_++] = length;
+}
+
+void LineSplitter::split(const char *const data, const std::size_t size, const bool trailingLine)
+{
+    nLines_ = 0;
+    if (size == 0) return;
+
+    std::size_t lineStart = 0;
+    std::size_t pos = 0;
+    for (; pos < size; pos += TagBlockSize) {
+        unsigned newlines = 0;
+        if (size - pos >= TagBlockSize) {
+            newlines = matchTags(reinterpret_cast<const unsigned char *>(data + pos), '\n');
+        } else {
+            unsigned char tail[TagBlockSize]{};
+            std::memcpy(tail, data + pos, size - pos);
+            newlines = matchTags(tail, '\n') & ((1u << (size - pos)) - 1);
+        }
+
+        while (newlines != 0) {
+            const std::size_t newline = pos + __builtin_ctz(newlines);
+            pushLine(lineStart, newline - lineStart);
+            lineStart = newline + 1;
+            newlines &= newlines - 1;
+        }
+    }
+    if (trailingLine) pushLine(lineStart, size - lineStart);
+}
+
+void LineSplitter::clear()
+{
+    std::free(offsets_);
+    std::free(lengths_);
+
+    offsets_ = nullptr;
+    lengths_ = nullptr;
+    nLines_ = 0;
+    cap_ = 0;
+}
+
+std::size_t LineSplitter::size() const
+{
+    return nLines_;
+}
+
+std::size_t LineSplitter::offset(const std::size_t idx) const
+{
+    return offsets_[idx];
+}
+
+std::size_t LineSplitter::length(const std::size_t idx) const
+{
+    return lengths_[idx];
+}
+
+void LineSplitter::copyKeys(const char *const data, const std::size_t size, LineSplitter::String keys[]) const
+{
+    for (std::size_t idx = 0; idx < nLines_; ++idx) copyKey(keys[idx], data + offsets_[idx], lengths_[idx], data + size);
+}
+
+void LineSplitter::copyKey(LineSplitter::String &dst, const char *const src, const std::size_t len,
+                           const char *const srcEnd)
+{
+    const std::size_t keyLen = (len > HashTable::StringSize - 1) ? HashTable::StringSize - 1 : len;
+
+    if (static_cast<std::size_t>(srcEnd - src) < HashTable::StringSize) {
+        std::memset(dst, 0, sizeof(String));
+        std::memcpy(dst, src, keyLen);
+        return;
+    }
+
+    const __m128i keyLenVec = _mm_set1_epi8(static_cast<char>(keyLen));
+    __m128i idxVec = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    for (std::size_t k = 0; k < sizeof(String); k += sizeof(__m128i)) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + k));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + k), _mm_and_si128(bytes, _mm_cmpgt_epi8(keyLenVec, idxVec)));
+        idxVec = _mm_add_epi8(idxVec, _mm_set1_epi8(sizeof(__m128i)));
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef LINESPLITTER_HPP
+#define LINESPLITTER_HPP
+
+#include <cstddef>
+
+#include "HashTable.hpp"
+
+class LineSplitter {
+public:
+    typedef HashTable::String String;
+
+    LineSplitter() = default;
+
+    LineSplitter(const LineSplitter &) = delete;
+    LineSplitter &operator=(const LineSplitter &) = delete;
+
+    ~LineSplitter();
+
+    void split(const char *data, std::size_t size, bool trailingLine = true);
+    void clear();
+
+    std::size_t size() const;
+    std::size_t offset(std::size_t idx) const;
+    std::size_t length(std::size_t idx) const;
+
+    void copyKeys(const char *data, std::size_t size, String keys[]) const;
+    static void copyKey(String &dst, const char *src, std::size_t len, const char *srcEnd);
+
+private:
+    void pushLine(std::size_t offset, std::size_t length);
+
+    std::size_t *offsets_{};
+    std::size_t *lengths_{};
+    std::size_t nLines_{};
+    std::size_t cap_{};
+};
+
+#endif /* LINESPLITTER_HPP */
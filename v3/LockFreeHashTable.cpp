@@ -0,0 +1,111 @@
+#include "LockFreeHashTable.hpp"
+
+const LockFreeHashTable::String LockFreeHashTable::tombstone_{};
+
+LockFreeHashTable::LockFreeHashTable(unsigned long long (*const hashFunc)(const LockFreeHashTable::String &),
+                                     const std::size_t capacity)
+: slots_(nullptr), mask_(0), hashFunc_(hashFunc)
+{
+    std::size_t nSlots = 1;
+    while (nSlots < capacity) nSlots <<= 1;
+
+    slots_ = new Slot[nSlots]{};
+    mask_ = nSlots - 1;
+}
+
+LockFreeHashTable::~LockFreeHashTable()
+{
+    delete[] slots_;
+}
+
+unsigned long long LockFreeHashTable::keyWord(const LockFreeHashTable::String &key)
+{
+    return *reinterpret_cast<const unsigned long long *>(key);
+}
+
+LockFreeHashTable::Slot *LockFreeHashTable::findSlot(const unsigned long long word, const unsigned long long hash) const
+{
+    if (word == 0) return const_cast<Slot *>(&zeroWordSlot_);
+
+    for (std::size_t probe = 0, idx = hash & mask_; probe <= mask_; ++probe, idx = (idx + 1) & mask_) {
+        const unsigned long long slotWord = slots_[idx].word.load(std::memory_order_acquire);
+        if (slotWord == word) return slots_ + idx;
+        if (slotWord == 0) return nullptr;
+    }
+
+    return nullptr;
+}
+
+LockFreeHashTable::Slot *LockFreeHashTable::claimSlot(const unsigned long long word, const unsigned long long hash)
+{
+    if (word == 0) return &zeroWordSlot_;
+
+    for (std::size_t probe = 0, idx = hash & mask_; probe <= mask_; ++probe, idx = (idx + 1) & mask_) {
+        unsigned long long slotWord = slots_[idx].word.load(std::memory_order_acquire);
+        if ((slotWord == 0) &&
+            slots_[idx].word.compare_exchange_strong(slotWord, word, std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+            return slots_ + idx;
+        }
+
+        if (slotWord == word) return slots_ + idx;
+    }
+
+    return nullptr;
+}
+
+bool LockFreeHashTable::publish(LockFreeHashTable::Slot &slot, const LockFreeHashTable::String &val)
+{
+    const String *curr = slot.val.load(std::memory_order_acquire);
+    do {
+        if ((curr != nullptr) && (curr != &tombstone_)) return false;
+    } while (!slot.val.compare_exchange_weak(curr, &val, std::memory_order_release, std::memory_order_acquire));
+
+    return true;
+}
+
+bool LockFreeHashTable::retract(LockFreeHashTable::Slot &slot)
+{
+    const String *curr = slot.val.load(std::memory_order_acquire);
+    do {
+        if ((curr == nullptr) || (curr == &tombstone_)) return false;
+    } while (!slot.val.compare_exchange_weak(curr, &tombstone_, std::memory_order_release, std::memory_order_acquire));
+
+    return true;
+}
+
+bool LockFreeHashTable::insert(const LockFreeHashTable::Entry &entry)
+{
+    return insert(*entry.key, *entry.val);
+}
+
+bool LockFreeHashTable::insert(const LockFreeHashTable::String &key, const LockFreeHashTable::String &val)
+{
+    Slot *slot = claimSlot(keyWord(key), hashFunc_(key));
+    if (slot == nullptr) return false;
+
+    return publish(*slot, val);
+}
+
+bool LockFreeHashTable::remove(const LockFreeHashTable::String &key)
+{
+    Slot *slot = findSlot(keyWord(key), hashFunc_(key));
+    if (slot == nullptr) return false;
+
+    return retract(*slot);
+}
+
+const LockFreeHashTable::String *LockFreeHashTable::find(const LockFreeHashTable::String &key) const
+{
+    const Slot *slot = findSlot(keyWord(key), hashFunc_(key));
+    if (slot == nullptr) return nullptr;
+
+    const String *val = slot->val.load(std::memory_order_acquire);
+
+    return (val == &tombstone_) ? nullptr : val;
+}
+
+std::size_t LockFreeHashTable::capacity() const
+{
+    return mask_ + 1;
+}
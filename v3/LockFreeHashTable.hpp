@@ -0,0 +1,52 @@
+#ifndef LOCKFREEHASHTABLE_HPP
+#define LOCKFREEHASHTABLE_HPP
+
+#include <atomic>
+
+#include "HashTable.hpp"
+
+class LockFreeHashTable {
+public:
+    typedef HashTable::String String;
+    typedef HashTable::Entry Entry;
+
+    LockFreeHashTable() = delete;
+    LockFreeHashTable(unsigned long long (*hashFunc)(const String &), std::size_t capacity);
+
+    LockFreeHashTable(const LockFreeHashTable &) = delete;
+    LockFreeHashTable &operator=(const LockFreeHashTable &) = delete;
+
+    ~LockFreeHashTable();
+
+    bool insert(const Entry &entry);
+    bool insert(const String &key, const String &val);
+    bool remove(const String &key);
+    const String *find(const String &key) const;
+
+    std::size_t capacity() const;
+
+private:
+    struct alignas(16) Slot {
+        std::atomic<unsigned long long> word;
+        std::atomic<const String *> val;
+    };
+
+    static unsigned long long keyWord(const String &key);
+
+    Slot *findSlot(unsigned long long word, unsigned long long hash) const;
+    Slot *claimSlot(unsigned long long word, unsigned long long hash);
+
+    static bool publish(Slot &slot, const String &val);
+    static bool retract(Slot &slot);
+
+    static const String tombstone_;
+
+    Slot *slots_;
+    std::size_t mask_;
+
+    Slot zeroWordSlot_{};
+
+    unsigned long long (*hashFunc_)(const String &);
+};
+
+#endif /* LOCKFREEHASHTABLE_HPP */
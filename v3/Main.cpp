@@ -1,83 +1,113 @@
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
 
-#include <sys/stat.h>
+#include <immintrin.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include "HashTable.hpp"
+#include "NumaHashTable.hpp"
+#include "WordLoader.hpp"
+#include "WyRand.hpp"
 
-std::size_t fileSize(const char *name);
-std::size_t cntLines(const char *strg);
-void readLinesFromStorage(const char *strg, HashTable::String *lines[]);
+bool pinToCore(std::thread &thread, unsigned core);
 
-signed main()
+signed main(int argc, char *argv[])
 {
     const std::size_t nLookUps = 100000000;
-    std::srand(time(nullptr));
+    const unsigned nThreads = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1;
+    if (nThreads == 0) {
+        std::fprintf(stderr, "usage: [FRONT_CACHE_SETS=n] %s [nThreads [core...]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
 
-    const size_t fileSz = fileSize("words.txt");
-    std::FILE *wordStream = std::fopen("words.txt", "rb");
-    auto strg = new char[fileSz + 1]{};
-    std::fread(strg, sizeof(*strg), fileSz, wordStream);
-    std::fclose(wordStream);
+    // Uniform lookups rarely hit a small cache, so the per-thread front cache is opt-in for skewed key sets.
+    const char *const frontCacheEnv = std::getenv("FRONT_CACHE_SETS");
+    const std::size_t frontCacheSets = (frontCacheEnv != nullptr) ? std::strtoul(frontCacheEnv, nullptr, 10) : 0;
 
-    const std::size_t nLines = cntLines(strg);
-    auto lines = new HashTable::String *[nLines]{};
-    readLinesFromStorage(strg, lines);
-    delete[] strg;
+    WordList words;
+    if (!words.load("words.txt", std::thread::hardware_concurrency())) {
+        std::fprintf(stderr, "cannot load words.txt\n");
+        return EXIT_FAILURE;
+    }
+    const std::size_t nLines = words.size();
 
-    HashTable hashTable{crc32Hash};
+    NumaHashTable numaHashTable{crc32Hash};
 
     HashTable::String placeholder{""};
-    for (std::size_t i = 0; i < nLines; ++i) {
-        hashTable.insert(*lines[i], placeholder);
+    auto entries = new HashTable::Entry[nLines];
+    for (std::size_t i = 0; i < nLines; ++i) entries[i] = HashTable::Entry{.key = &words[i], .val = &placeholder};
+    if (!numaHashTable.build(entries, nLines)) std::fprintf(stderr, "cannot bind replicas to their NUMA nodes\n");
+    delete[] entries;
+
+    const unsigned long long seed = std::time(nullptr);
+    auto threads = new std::thread[nThreads];
+    auto seconds = new double[nThreads]{};
+    auto hitRates = new double[nThreads]{};
+    std::atomic<unsigned> nReady{0};
+
+    for (unsigned t = 0; t < nThreads; ++t) {
+        const std::size_t nThreadLookUps = nLookUps * (t + 1) / nThreads - nLookUps * t / nThreads;
+        threads[t] = std::thread([&, t, nThreadLookUps] {
+            WyRand rng{seed + t};
+
+            nReady.fetch_add(1, std::memory_order_acq_rel);
+            while (nReady.load(std::memory_order_acquire) != nThreads + 1) _mm_pause();
+
+            // Allocated by the worker itself, so the cache lands on the worker's NUMA node.
+            const HashTable &hashTable = numaHashTable.local();
+            auto cache = (frontCacheSets != 0) ? new FrontCache<HashTable::Entry>{frontCacheSets} : nullptr;
+
+            const auto start = std::chrono::steady_clock::now();
+            if (cache != nullptr) {
+                for (std::size_t i = 0; i < nThreadLookUps; ++i) hashTable.find(words[rng.nextBelow(nLines)], *cache);
+            } else {
+                for (std::size_t i = 0; i < nThreadLookUps; ++i) hashTable.find(words[rng.nextBelow(nLines)]);
+            }
+            seconds[t] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (cache != nullptr) {
+                hitRates[t] = static_cast<double>(cache->hits()) / static_cast<double>(nThreadLookUps);
+                delete cache;
+            }
+        });
+
+        const unsigned core = (static_cast<unsigned>(argc) > t + 2) ? std::strtoul(argv[t + 2], nullptr, 10) : t;
+        if (!pinToCore(threads[t], core)) std::fprintf(stderr, "thread %u: cannot pin to core %u\n", t, core);
     }
+    nReady.fetch_add(1, std::memory_order_acq_rel);
+
+    double maxSeconds = 0;
+    for (unsigned t = 0; t < nThreads; ++t) {
+        threads[t].join();
+
+        const std::size_t nThreadLookUps = nLookUps * (t + 1) / nThreads - nLookUps * t / nThreads;
+        std::printf("thread %u: %zu lookups in %.3f s, %.2f M lookups/s", t, nThreadLookUps, seconds[t],
+                    static_cast<double>(nThreadLookUps) / seconds[t] / 1e6);
+        if (frontCacheSets != 0) std::printf(", %.1f%% front cache hits", hitRates[t] * 100);
+        std::printf("\n");
+        if (seconds[t] > maxSeconds) maxSeconds = seconds[t];
+    }
+    std::printf("total: %zu lookups on %u threads in %.3f s, %.2f M lookups/s\n", nLookUps, nThreads, maxSeconds,
+                static_cast<double>(nLookUps) / maxSeconds / 1e6);
 
-    for (std::size_t i = 0; i < nLookUps; ++i) hashTable.find(*lines[std::rand() % nLines]);
-
-    for (size_t i = 0; i < nLines; ++i) std::free(lines[i]);
-    delete[] lines;
+    delete[] hitRates;
+    delete[] seconds;
+    delete[] threads;
 
     return EXIT_SUCCESS;
 }
 
-std::size_t fileSize(const char *const name)
-{
-    struct stat buf{};
-    stat(name, &buf);
-
-    return buf.st_size;
-}
-
-std::size_t cntLines(const char *strg)
-{
-    if (*strg == '\0') return 0;
-
-    std::size_t nLines = 0;
-    while (*strg != '\0') {
-        if (*strg++ == '\n') ++nLines;
-    }
-
-    return nLines + 1;
-}
-
-void readLinesFromStorage(const char *strg, HashTable::String *lines[])
+bool pinToCore(std::thread &thread, const unsigned core)
 {
-    const char *currLine = strg;
-    size_t lineLen = 0;
-    size_t idx = 0;
-    while (*strg != '\0') {
-        if (*strg++ == '\n') {
-            lines[idx] = static_cast<HashTable::String *>(std::calloc(1, sizeof(HashTable::String)));
-
-            lineLen = strg - 1 - currLine;
-            std::strncpy(static_cast<char *>(*lines[idx++]), currLine,
-                         (lineLen > HashTable::StringSize - 1) ? HashTable::StringSize - 1 : lineLen);
-            currLine = strg;
-        }
-    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
 
-    lines[idx] = static_cast<HashTable::String *>(std::calloc(1, sizeof(HashTable::String)));
-    lineLen = (strg == currLine) ? 0 : strg - currLine;
-    std::strncpy(static_cast<char *>(*lines[idx]), currLine,
-                 (lineLen > HashTable::StringSize - 1) ? HashTable::StringSize - 1 : lineLen);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus) == 0;
 }
@@ -0,0 +1,16 @@
+#ifndef MIX_HPP
+#define MIX_HPP
+
+// The murmur3 fmix64 finalizer: every input bit affects every output bit.
+inline unsigned long long mix64(unsigned long long hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+#endif /* MIX_HPP */
@@ -0,0 +1,140 @@
+#include "NumaHashTable.hpp"
+
+#include <cstdio>
+
+#include <pthread.h>
+
+#include <atomic>
+#include <thread>
+
+NumaHashTable::NumaHashTable(unsigned long long (*const hashFunc)(const NumaHashTable::String &))
+: nodes_(nullptr), nNodes_(0), cpuNodes_{}, hashFunc_(hashFunc)
+{
+    discoverNodes();
+}
+
+NumaHashTable::~NumaHashTable()
+{
+    clear();
+    delete[] nodes_;
+}
+
+bool NumaHashTable::readCpuList(const char *const path, cpu_set_t &cpus)
+{
+    CPU_ZERO(&cpus);
+
+    std::FILE *stream = std::fopen(path, "r");
+    if (stream == nullptr) return false;
+
+    unsigned first = 0;
+    unsigned last = 0;
+    int sep = 0;
+    while (std::fscanf(stream, "%u", &first) == 1) {
+        last = first;
+        sep = std::fgetc(stream);
+        if ((sep == '-') && (std::fscanf(stream, "%u", &last) == 1)) sep = std::fgetc(stream);
+
+        for (unsigned cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); ++cpu) CPU_SET(cpu, &cpus);
+        if (sep != ',') break;
+    }
+    std::fclose(stream);
+
+    return CPU_COUNT(&cpus) != 0;
+}
+
+void NumaHashTable::discoverNodes()
+{
+    cpu_set_t online;
+    if (!readCpuList("/sys/devices/system/node/online", online)) {
+        CPU_ZERO(&online);
+        CPU_SET(0, &online);
+    }
+
+    std::size_t maxNode = 0;
+    for (std::size_t node = 0; node < CPU_SETSIZE; ++node) {
+        if (CPU_ISSET(node, &online)) maxNode = node;
+    }
+
+    nodes_ = new Node[maxNode + 1]{};
+    for (std::size_t node = 0; node <= maxNode; ++node) {
+        char path[64];
+        std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", node);
+        if (!CPU_ISSET(node, &online) || !readCpuList(path, nodes_[nNodes_].cpus)) continue;
+
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &nodes_[nNodes_].cpus)) cpuNodes_[cpu] = nNodes_;
+        }
+        ++nNodes_;
+    }
+
+    if (nNodes_ == 0) {
+        sched_getaffinity(0, sizeof(nodes_[0].cpus), &nodes_[0].cpus);
+        nNodes_ = 1;
+    }
+}
+
+bool NumaHashTable::build(const NumaHashTable::Entry entries[], const std::size_t n)
+{
+    clear();
+
+    auto threads = new std::thread[nNodes_];
+    std::atomic<bool> pinned{true};
+    for (std::size_t node = 0; node < nNodes_; ++node) {
+        threads[node] = std::thread([this, entries, n, node, &pinned] {
+            Node &local = nodes_[node];
+            if (pthread_setaffinity_np(pthread_self(), sizeof(local.cpus), &local.cpus) != 0) {
+                pinned.store(false, std::memory_order_relaxed);
+            }
+
+            local.table = new HashTable{hashFunc_};
+            local.table->insert(entries, n, CPU_COUNT(&local.cpus));
+            local.table->freeze();
+        });
+    }
+    for (std::size_t node = 0; node < nNodes_; ++node) threads[node].join();
+    delete[] threads;
+
+    return pinned.load(std::memory_order_relaxed);
+}
+
+std::size_t NumaHashTable::nNodes() const
+{
+    return nNodes_;
+}
+
+std::size_t NumaHashTable::nodeOfCpu(const unsigned cpu) const
+{
+    return (cpu < CPU_SETSIZE) ? cpuNodes_[cpu] : 0;
+}
+
+const cpu_set_t &NumaHashTable::nodeCpus(const std::size_t node) const
+{
+    return nodes_[node].cpus;
+}
+
+const HashTable &NumaHashTable::replica(const std::size_t node) const
+{
+    return *nodes_[node].table;
+}
+
+const HashTable &NumaHashTable::local() const
+{
+    const int cpu = sched_getcpu();
+
+    return replica((cpu < 0) ? 0 : nodeOfCpu(static_cast<unsigned>(cpu)));
+}
+
+const NumaHashTable::String *NumaHashTable::find(const NumaHashTable::String &key) const
+{
+    if (nodes_[0].table == nullptr) return nullptr;
+
+    return local().find(key);
+}
+
+void NumaHashTable::clear()
+{
+    for (std::size_t node = 0; node < nNodes_; ++node) {
+        delete nodes_[node].table;
+        nodes_[node].table = nullptr;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef NUMAHASHTABLE_HPP
+#define NUMAHASHTABLE_HPP
+
+#include <sched.h>
+
+#include "HashTable.hpp"
+
+class NumaHashTable {
+public:
+    typedef HashTable::String String;
+    typedef HashTable::Entry Entry;
+
+    NumaHashTable() = delete;
+    explicit NumaHashTable(unsigned long long (*hashFunc)(const String &));
+
+    NumaHashTable(const NumaHashTable &) = delete;
+    NumaHashTable &operator=(const NumaHashTable &) = delete;
+
+    ~NumaHashTable();
+
+    bool build(const Entry entries[], std::size_t n);
+
+    std::size_t nNodes() const;
+    std::size_t nodeOfCpu(unsigned cpu) const;
+    const cpu_set_t &nodeCpus(std::size_t node) const;
+
+    const HashTable &replica(std::size_t node) const;
+    const HashTable &local() const;
+
+    const String *find(const String &key) const;
+
+    void clear();
+
+private:
+    struct Node {
+        HashTable *table;
+        cpu_set_t cpus;
+    };
+
+    static bool readCpuList(const char *path, cpu_set_t &cpus);
+
+    void discoverNodes();
+
+    Node *nodes_;
+    std::size_t nNodes_;
+    std::size_t cpuNodes_[CPU_SETSIZE];
+
+    unsigned long long (*hashFunc_)(const String &);
+};
+
+#endif /* NUMAHASHTABLE_HPP */
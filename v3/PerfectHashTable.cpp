@@ -0,0 +1,226 @@
+#include "PerfectHashTable.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "Mix.hpp"
+
+PerfectHashTable::~PerfectHashTable()
+{
+    clear();
+}
+
+unsigned long long PerfectHashTable::keyHash(const PerfectHashTable::String &key)
+{
+    return mix64(*reinterpret_cast<const unsigned long long *>(key));
+}
+
+std::size_t PerfectHashTable::bucketIdx(const PerfectHashTable::String &key, const unsigned long long keyHash) const
+{
+    const unsigned long long regionHash = keyHash & 0xFFFFFFFFull;
+    if ((crc32Hash(key) & 0xFFFFFFFFull) < denseKeysThreshold_) return (regionHash * nDenseBuckets_) >> 32;
+
+    return nDenseBuckets_ + ((regionHash * (nBuckets_ - nDenseBuckets_)) >> 32);
+}
+
+std::size_t PerfectHashTable::slotIdx(const unsigned long long keyHash, const unsigned short pilot) const
+{
+    const unsigned long long hash = keyHash ^ mix64((seed_ << 16) | pilot);
+
+    return static_cast<std::size_t>((static_cast<unsigned __int128>(hash) * nSlots_) >> 64);
+}
+
+int PerfectHashTable::compareHashes(const void *const arg1, const void *const arg2)
+{
+    const unsigned long long hash1 = *static_cast<const unsigned long long *>(arg1);
+    const unsigned long long hash2 = *static_cast<const unsigned long long *>(arg2);
+
+    return (hash1 > hash2) - (hash1 < hash2);
+}
+
+std::size_t PerfectHashTable::countUnique(const unsigned long long keyHashes[], const std::size_t n)
+{
+    auto sorted = new unsigned long long[n];
+    std::memcpy(sorted, keyHashes, n * sizeof(*sorted));
+    std::qsort(sorted, n, sizeof(*sorted), compareHashes);
+
+    std::size_t nUnique = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if ((i == 0) || (sorted[i] != sorted[i - 1])) ++nUnique;
+    }
+    delete[] sorted;
+
+    return nUnique;
+}
+
+bool PerfectHashTable::build(const PerfectHashTable::Entry entries[], const std::size_t n)
+{
+    clear();
+    if (n == 0) return true;
+
+    auto keyHashes = new unsigned long long[n];
+    for (std::size_t i = 0; i < n; ++i) keyHashes[i] = keyHash(*entries[i].key);
+
+    // Size the pilot table for the distinct keys, so duplicates in the input do not inflate bits per key.
+    nBuckets_ = countUnique(keyHashes, n) / bucketLoad_ + 1;
+    nDenseBuckets_ = nBuckets_ * 3 / 10;
+
+    auto keyBuckets = new std::size_t[n];
+    auto bucketStarts = new std::size_t[nBuckets_ + 1]{};
+    for (std::size_t i = 0; i < n; ++i) {
+        keyBuckets[i] = bucketIdx(*entries[i].key, keyHashes[i]);
+        ++bucketStarts[keyBuckets[i] + 1];
+    }
+    for (std::size_t b = 0; b < nBuckets_; ++b) bucketStarts[b + 1] += bucketStarts[b];
+
+    auto keyIdxs = new std::size_t[n];
+    auto bucketSizes = new std::size_t[nBuckets_]{};
+    for (std::size_t i = 0; i < n; ++i) {
+        keyIdxs[bucketStarts[keyBuckets[i]] + bucketSizes[keyBuckets[i]]++] = i;
+    }
+
+    std::size_t maxBucketSize = 0;
+    for (std::size_t b = 0; b < nBuckets_; ++b) {
+        std::size_t *bucketKeys = keyIdxs + bucketStarts[b];
+
+        std::size_t nUnique = 0;
+        for (std::size_t j = 0; j < bucketSizes[b]; ++j) {
+            std::size_t k = 0;
+            while ((k < nUnique) && (keyHashes[bucketKeys[k]] != keyHashes[bucketKeys[j]])) ++k;
+            if (k == nUnique) bucketKeys[nUnique++] = bucketKeys[j];
+        }
+
+        bucketSizes[b] = nUnique;
+        size_ += nUnique;
+        if (nUnique > maxBucketSize) maxBucketSize = nUnique;
+    }
+
+    auto sizeStarts = new std::size_t[maxBucketSize + 2]{};
+    for (std::size_t b = 0; b < nBuckets_; ++b) ++sizeStarts[maxBucketSize - bucketSizes[b] + 1];
+    for (std::size_t s = 0; s <= maxBucketSize; ++s) sizeStarts[s + 1] += sizeStarts[s];
+
+    auto bucketOrder = new std::size_t[nBuckets_];
+    for (std::size_t b = 0; b < nBuckets_; ++b) bucketOrder[sizeStarts[maxBucketSize - bucketSizes[b]]++] = b;
+
+    nSlots_ = static_cast<std::size_t>(size_ / loadFactor_) + 1;
+
+    bool built = false;
+    for (std::size_t attempt = 0; (attempt < maxAttempts_) && !built; ++attempt) {
+        seed_ = attempt;
+        built = placeBuckets(entries, keyHashes, bucketStarts, bucketSizes, bucketOrder, keyIdxs, maxBucketSize);
+        if (!built) nSlots_ += nSlots_ / 64 + 1;
+    }
+
+    delete[] bucketOrder;
+    delete[] sizeStarts;
+    delete[] bucketSizes;
+    delete[] keyIdxs;
+    delete[] bucketStarts;
+    delete[] keyBuckets;
+    delete[] keyHashes;
+
+    if (!built) clear();
+
+    return built;
+}
+
+bool PerfectHashTable::placeBuckets(const PerfectHashTable::Entry entries[], const unsigned long long keyHashes[],
+                                    const std::size_t bucketStarts[], const std::size_t bucketSizes[],
+                                    const std::size_t bucketOrder[], const std::size_t keyIdxs[],
+                                    const std::size_t maxBucketSize)
+{
+    std::free(slots_);
+    std::free(pilots_);
+    slots_ = static_cast<Entry *>(std::calloc(nSlots_, sizeof(*slots_)));
+    pilots_ = static_cast<unsigned short *>(std::calloc(nBuckets_, sizeof(*pilots_)));
+
+    const std::size_t wordBits = CHAR_BIT * sizeof(unsigned long long);
+    auto taken = new unsigned long long[nSlots_ / wordBits + 1]{};
+    auto positions = new std::size_t[maxBucketSize + 1];
+
+    bool placed = true;
+    for (std::size_t o = 0; (o < nBuckets_) && placed; ++o) {
+        const std::size_t b = bucketOrder[o];
+        const std::size_t bucketSize = bucketSizes[b];
+        if (bucketSize == 0) break;
+
+        const std::size_t *bucketKeys = keyIdxs + bucketStarts[b];
+
+        std::size_t pilot = 0;
+        for (; pilot <= maxPilot_; ++pilot) {
+            std::size_t j = 0;
+            for (; j < bucketSize; ++j) {
+                positions[j] = slotIdx(keyHashes[bucketKeys[j]], static_cast<unsigned short>(pilot));
+                if (taken[positions[j] / wordBits] & (1ull << (positions[j] % wordBits))) break;
+
+                std::size_t k = 0;
+                while ((k < j) && (positions[k] != positions[j])) ++k;
+                if (k != j) break;
+            }
+
+            if (j == bucketSize) break;
+        }
+
+        if (pilot > maxPilot_) {
+            placed = false;
+            break;
+        }
+
+        pilots_[b] = static_cast<unsigned short>(pilot);
+        for (std::size_t j = 0; j < bucketSize; ++j) {
+            taken[positions[j] / wordBits] |= 1ull << (positions[j] % wordBits);
+            slots_[positions[j]] = entries[bucketKeys[j]];
+        }
+    }
+
+    delete[] positions;
+    delete[] taken;
+
+    return placed;
+}
+
+const PerfectHashTable::String *PerfectHashTable::find(const PerfectHashTable::String &key) const
+{
+    if (size_ == 0) return nullptr;
+
+    const unsigned long long hash = keyHash(key);
+    const Entry &slot = slots_[slotIdx(hash, pilots_[bucketIdx(key, hash)])];
+    if (!(slot == Entry{.key = &key, .val = nullptr})) return nullptr;
+
+    return slot.val;
+}
+
+void PerfectHashTable::clear()
+{
+    std::free(slots_);
+    std::free(pilots_);
+    slots_ = nullptr;
+    pilots_ = nullptr;
+
+    size_ = 0;
+    nBuckets_ = 0;
+    nDenseBuckets_ = 0;
+    nSlots_ = 0;
+}
+
+std::size_t PerfectHashTable::size() const
+{
+    return size_;
+}
+
+std::size_t PerfectHashTable::nSlots() const
+{
+    return nSlots_;
+}
+
+double PerfectHashTable::bitsPerKey() const
+{
+    if (size_ == 0) return 0;
+
+    return static_cast<double>(CHAR_BIT * sizeof(*pilots_) * nBuckets_) / static_cast<double>(size_);
+}
+
+std::size_t PerfectHashTable::memoryUsage() const
+{
+    return nBuckets_ * sizeof(*pilots_) + nSlots_ * sizeof(*slots_);
+}
@@ -0,0 +1,58 @@
+#ifndef PERFECTHASHTABLE_HPP
+#define PERFECTHASHTABLE_HPP
+
+#include <cstddef>
+
+#include "HashTable.hpp"
+
+class PerfectHashTable {
+public:
+    typedef HashTable::String String;
+    typedef HashTable::Entry Entry;
+
+    PerfectHashTable() = default;
+
+    PerfectHashTable(const PerfectHashTable &) = delete;
+    PerfectHashTable &operator=(const PerfectHashTable &) = delete;
+
+    ~PerfectHashTable();
+
+    bool build(const Entry entries[], std::size_t n);
+    const String *find(const String &key) const;
+
+    void clear();
+
+    std::size_t size() const;
+    std::size_t nSlots() const;
+    double bitsPerKey() const;
+    std::size_t memoryUsage() const;
+
+private:
+    static const std::size_t bucketLoad_ = 5;
+    static const std::size_t maxPilot_ = 0xFFFF;
+    static const std::size_t maxAttempts_ = 8;
+    static constexpr double loadFactor_ = 0.95;
+    static const unsigned long long denseKeysThreshold_ = 0xFFFFFFFFull * 6 / 10;
+
+    static unsigned long long keyHash(const String &key);
+    static int compareHashes(const void *arg1, const void *arg2);
+    static std::size_t countUnique(const unsigned long long keyHashes[], std::size_t n);
+
+    std::size_t bucketIdx(const String &key, unsigned long long keyHash) const;
+    std::size_t slotIdx(unsigned long long keyHash, unsigned short pilot) const;
+
+    bool placeBuckets(const Entry entries[], const unsigned long long keyHashes[], const std::size_t bucketStarts[],
+                      const std::size_t bucketSizes[], const std::size_t bucketOrder[], const std::size_t keyIdxs[],
+                      std::size_t maxBucketSize);
+
+    std::size_t size_{};
+    std::size_t nBuckets_{};
+    std::size_t nDenseBuckets_{};
+    std::size_t nSlots_{};
+    unsigned long long seed_{};
+
+    unsigned short *pilots_{};
+    Entry *slots_{};
+};
+
+#endif /* PERFECTHASHTABLE_HPP */
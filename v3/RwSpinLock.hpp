@@ -0,0 +1,54 @@
+#ifndef RWSPINLOCK_HPP
+#define RWSPINLOCK_HPP
+
+#include <atomic>
+
+#include <immintrin.h>
+
+class alignas(64) RwSpinLock {
+public:
+    void lock()
+    {
+        for (;;) {
+            unsigned state = state_.load(std::memory_order_relaxed);
+            if (((state & ~WriterPending) == 0) &&
+                state_.compare_exchange_weak(state, Writer, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+
+            if (!(state & WriterPending)) state_.fetch_or(WriterPending, std::memory_order_relaxed);
+            _mm_pause();
+        }
+    }
+
+    void unlock()
+    {
+        state_.fetch_and(~Writer, std::memory_order_release);
+    }
+
+    void lockShared()
+    {
+        for (;;) {
+            unsigned state = state_.load(std::memory_order_relaxed);
+            if (!(state & (Writer | WriterPending)) &&
+                state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+
+            _mm_pause();
+        }
+    }
+
+    void unlockShared()
+    {
+        state_.fetch_sub(1, std::memory_order_release);
+    }
+
+private:
+    static const unsigned Writer = 1u << 31;
+    static const unsigned WriterPending = 1u << 30;
+
+    std::atomic<unsigned> state_{0};
+};
+
+#endif /* RWSPINLOCK_HPP */
@@ -0,0 +1,136 @@
+#include "SeqlockHashTable.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <immintrin.h>
+
+#include "EpochReclaimer.hpp"
+
+SeqlockHashTable::SeqlockHashTable(unsigned long long (*const hashFunc)(const SeqlockHashTable::String &))
+: buckets_{}, hashFunc_(hashFunc)
+{
+    for (auto &bucket: buckets_) bucket.list.setRetireFunc(retire, this);
+}
+
+SeqlockHashTable::~SeqlockHashTable()
+{
+    for (auto &bucket: buckets_) retireKeys(bucket);
+    EpochReclaimer::instance().reclaim(this);
+}
+
+std::size_t SeqlockHashTable::hashFuncModulusWrapper(const unsigned long long hash) const
+{
+    return hash % sz_;
+}
+
+void SeqlockHashTable::beginWrite(SeqlockHashTable::Bucket &bucket)
+{
+    for (;;) {
+        unsigned long seq = bucket.seq.load(std::memory_order_relaxed);
+        if (!(seq & 1) &&
+            bucket.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            break;
+        }
+
+        _mm_pause();
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SeqlockHashTable::endWrite(SeqlockHashTable::Bucket &bucket)
+{
+    bucket.seq.fetch_add(1, std::memory_order_release);
+}
+
+void SeqlockHashTable::retire(void *const ctx, void *const ptr, const std::size_t bytes)
+{
+    EpochReclaimer::instance().retire(ptr, bytes, ctx);
+}
+
+void SeqlockHashTable::insert(const SeqlockHashTable::Entry &entry)
+{
+    insert(*entry.key, *entry.val);
+}
+
+void SeqlockHashTable::insert(const SeqlockHashTable::String &key, const SeqlockHashTable::String &val)
+{
+    const unsigned long long hash = hashFunc_(key);
+    Bucket &bucket = buckets_[hashFuncModulusWrapper(hash)];
+
+    // Copied outside the write section, so that readers of the bucket do not wait on the allocation.
+    auto ownedKey = static_cast<String *>(std::aligned_alloc(sizeof(String), sizeof(String)));
+    std::memcpy(*ownedKey, key, sizeof(String));
+
+    Entry entry{.key = ownedKey, .val = &val};
+    const unsigned char tag = tagOf(hash);
+
+    beginWrite(bucket);
+    const bool inserted = bucket.list.findNodeByValue(entry, tag) == nullptr;
+    if (inserted) bucket.list.insertAfterHead(entry, tag);
+    endWrite(bucket);
+
+    if (!inserted) std::free(ownedKey);
+}
+
+bool SeqlockHashTable::remove(const SeqlockHashTable::String &key)
+{
+    const unsigned long long hash = hashFunc_(key);
+    Bucket &bucket = buckets_[hashFuncModulusWrapper(hash)];
+
+    beginWrite(bucket);
+    auto node = bucket.list.findNodeByValue(Entry{.key = &key, .val = nullptr}, tagOf(hash));
+    const String *removedKey = (node == nullptr) ? nullptr : node->data.key;
+    if (node != nullptr) bucket.list.deleteFromPhysicalPos(node->curr);
+    endWrite(bucket);
+
+    if (removedKey == nullptr) return false;
+
+    // A reader may have copied the entry just before the delete and still be comparing its key.
+    EpochReclaimer::instance().retire(const_cast<String *>(removedKey), sizeof(String), this);
+
+    return true;
+}
+
+const SeqlockHashTable::String *SeqlockHashTable::find(const SeqlockHashTable::String &key) const
+{
+    const unsigned long long hash = hashFunc_(key);
+    const Bucket &bucket = buckets_[hashFuncModulusWrapper(hash)];
+
+    const Entry entry{.key = &key, .val = nullptr};
+    const unsigned char tag = tagOf(hash);
+
+    EpochReclaimer::Guard guard;
+    for (;;) {
+        const unsigned long seq = bucket.seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            _mm_pause();
+            continue;
+        }
+
+        Entry found{};
+        const String *val = bucket.list.findValueConcurrent(entry, tag, found) ? found.val : nullptr;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (bucket.seq.load(std::memory_order_relaxed) == seq) return val;
+    }
+}
+
+void SeqlockHashTable::clear()
+{
+    for (auto &bucket: buckets_) {
+        beginWrite(bucket);
+        retireKeys(bucket);
+        bucket.list.clear();
+        endWrite(bucket);
+    }
+}
+
+void SeqlockHashTable::retireKeys(SeqlockHashTable::Bucket &bucket)
+{
+    auto &list = bucket.list;
+    for (auto node = list.tailNode(); node->curr != 0; node = list.nodeAfterPhysicalPos(node->curr)) {
+        EpochReclaimer::instance().retire(const_cast<String *>(node->data.key), sizeof(String), this);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef SEQLOCKHASHTABLE_HPP
+#define SEQLOCKHASHTABLE_HPP
+
+#include <atomic>
+
+#include "HashTable.hpp"
+
+class SeqlockHashTable {
+public:
+    typedef HashTable::String String;
+    typedef HashTable::Entry Entry;
+
+    SeqlockHashTable() = delete;
+    explicit SeqlockHashTable(unsigned long long (*hashFunc)(const String &));
+
+    SeqlockHashTable(const SeqlockHashTable &) = delete;
+    SeqlockHashTable &operator=(const SeqlockHashTable &) = delete;
+
+    ~SeqlockHashTable();
+
+    // Keys are copied into the table, and a removed key's copy is freed only after every reader that could still
+    // compare against it has left, so callers may reuse their key buffers at once. Values stay caller-owned:
+    // find() returns the caller's pointer, which must remain valid as long as any reader may still hold it.
+    void insert(const Entry &entry);
+    void insert(const String &key, const String &val);
+    bool remove(const String &key);
+    const String *find(const String &key) const;
+
+    void clear();
+
+private:
+    // Per-bucket seqlock. A writer makes seq odd with a CAS, changes the list, then makes it even again; writers of
+    // one bucket therefore exclude each other. A reader takes an even seq, copies the matching entry with atomic
+    // loads, and retries if seq changed meanwhile. The copy may be torn, but a torn copy is never returned. Arrays
+    // replaced by a grow stay mapped until EpochReclaimer frees them, since find() holds a Guard throughout.
+    struct alignas(64) Bucket {
+        std::atomic<unsigned long> seq{0};
+        DoublyLinkedArrayList<Entry> list;
+    };
+
+    std::size_t hashFuncModulusWrapper(unsigned long long hash) const;
+
+    static void beginWrite(Bucket &bucket);
+    static void endWrite(Bucket &bucket);
+
+    static void retire(void *ctx, void *ptr, std::size_t bytes);
+    void retireKeys(Bucket &bucket);
+
+    static const std::size_t sz_ = 1009;
+    Bucket buckets_[sz_];
+
+    unsigned long long (*hashFunc_)(const String &);
+};
+
+#endif /* SEQLOCKHASHTABLE_HPP */
@@ -0,0 +1,485 @@
+#include "ShardLoader.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+
+IoUring::~IoUring()
+{
+    close();
+}
+
+bool IoUring::open(const unsigned entries)
+{
+    close();
+
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd_ < 0) {
+        fd_ = -1;
+        return false;
+    }
+
+    // IORING_OP_READ arrived in the same kernel release as this feature bit.
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        close();
+        return false;
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        if (cqRingSize_ > sqRingSize_) sqRingSize_ = cqRingSize_;
+        cqRingSize_ = 0;
+    }
+
+    sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) {
+        sqRing_ = nullptr;
+        close();
+        return false;
+    }
+
+    cqRing_ = sqRing_;
+    if (!singleMmap) {
+        cqRing_ = mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                       IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) {
+            cqRing_ = nullptr;
+            close();
+            return false;
+        }
+    }
+
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        close();
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    auto sq = static_cast<char *>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sqMask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+    auto cq = static_cast<char *>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+void IoUring::close()
+{
+    if (sqes_ != nullptr) munmap(sqes_, sqesSize_);
+    if ((cqRing_ != nullptr) && (cqRing_ != sqRing_)) munmap(cqRing_, cqRingSize_);
+    if (sqRing_ != nullptr) munmap(sqRing_, sqRingSize_);
+    if (fd_ >= 0) ::close(fd_);
+
+    fd_ = -1;
+    nPending_ = 0;
+    sqRing_ = nullptr;
+    cqRing_ = nullptr;
+    sqes_ = nullptr;
+    sqHead_ = sqTail_ = sqArray_ = nullptr;
+    cqHead_ = cqTail_ = nullptr;
+    cqes_ = nullptr;
+}
+
+bool IoUring::prepRead(const int fd, void *const buf, const unsigned len, const unsigned long long offset,
+                       const unsigned long long userData)
+{
+    const unsigned tail = *sqTail_;
+    if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) > sqMask_) return false;
+
+    const unsigned idx = tail & sqMask_;
+    io_uring_sqe &sqe = sqes_[idx];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<unsigned long long>(buf);
+    sqe.len = len;
+    sqe.off = offset;
+    sqe.user_data = userData;
+
+    sqArray_[idx] = idx;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    ++nPending_;
+
+    return true;
+}
+
+bool IoUring::submitAndWait(const unsigned minComplete)
+{
+    for (;;) {
+        const long n = syscall(__NR_io_uring_enter, fd_, nPending_, minComplete, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (n >= 0) {
+            nPending_ -= static_cast<unsigned>(n);
+            return true;
+        }
+        if (errno != EINTR) return false;
+    }
+}
+
+bool IoUring::peek(io_uring_cqe &cqe)
+{
+    const unsigned head = *cqHead_;
+    if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) return false;
+
+    cqe = cqes_[head & cqMask_];
+    __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+struct ShardLoader::Shard {
+    int fd{-1};
+    HashTable *table{};
+    KeyArena *arena{};
+    StreamLoader loader;
+
+    unsigned long long fileSize{};
+    unsigned long long nextOffset{};
+    std::size_t nSubmitted{};
+    std::size_t nParsed{};
+    unsigned nInFlight{};
+    bool failed{};
+
+    char *bufs[ReadsPerShard]{};
+    unsigned long long offsets[ReadsPerShard]{};
+    unsigned wants[ReadsPerShard]{};
+    unsigned filled[ReadsPerShard]{};
+    bool ready[ReadsPerShard]{};
+};
+
+ShardLoader::ShardLoader(const std::size_t blockSize, const bool useIoUring)
+: blockSize_((blockSize == 0) ? DefaultBlockSize : blockSize), useIoUring_(useIoUring)
+{
+}
+
+bool ShardLoader::load(const char *const paths[], const std::size_t n, HashTable *const tables[],
+                       KeyArena *const arenas[], const ShardLoader::String &val, const unsigned nThreads)
+{
+    nLines_ = 0;
+    usedIoUring_ = false;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (tables[i]->frozen()) return false;
+    }
+    if (n == 0) return true;
+
+    if (useIoUring_) {
+        IoUring ring;
+        if (ring.open(MaxActiveShards * ReadsPerShard)) {
+            usedIoUring_ = true;
+            return loadIoUring(ring, paths, n, tables, arenas, val);
+        }
+    }
+
+    return loadThreaded(paths, n, tables, arenas, val, nThreads);
+}
+
+bool ShardLoader::loadIoUring(IoUring &ring, const char *const paths[], const std::size_t n,
+                              HashTable *const tables[], KeyArena *const arenas[], const ShardLoader::String &val)
+{
+    const std::size_t nSlots = (n < MaxActiveShards) ? n : MaxActiveShards;
+    auto shards = new Shard[nSlots];
+    for (std::size_t s = 0; s < nSlots; ++s) {
+        for (unsigned b = 0; b < ReadsPerShard; ++b) shards[s].bufs[b] = static_cast<char *>(std::malloc(blockSize_));
+    }
+
+    bool loaded = true;
+    std::size_t nextPath = 0;
+    std::size_t nActive = 0;
+    for (std::size_t s = 0; s < nSlots; ++s) {
+        if (startShard(ring, shards[s], s, paths, n, tables, arenas, val, nextPath, loaded)) ++nActive;
+    }
+
+    while (nActive != 0) {
+        if (!ring.submitAndWait(1)) {
+            loaded = false;
+            if (drain(ring, shards, nSlots)) break;
+
+            // The kernel may still write into the buffers, so they and the shards are leaked on purpose;
+            // only the file descriptors are released.
+            for (std::size_t s = 0; s < nSlots; ++s) {
+                if (shards[s].fd >= 0) ::close(shards[s].fd);
+                shards[s].fd = -1;
+            }
+
+            return false;
+        }
+
+        io_uring_cqe cqe;
+        while (ring.peek(cqe)) {
+            const std::size_t s = cqe.user_data / ReadsPerShard;
+            Shard &shard = shards[s];
+            complete(ring, shard, s, static_cast<unsigned>(cqe.user_data % ReadsPerShard), cqe.res, val);
+
+            const bool drained = (shard.nParsed == shard.nSubmitted) && (shard.nextOffset >= shard.fileSize);
+            if ((shard.nInFlight != 0) || (!shard.failed && !drained)) continue;
+
+            if (shard.failed) loaded = false;
+            closeShard(shard, val);
+
+            if (!startShard(ring, shard, s, paths, n, tables, arenas, val, nextPath, loaded)) --nActive;
+        }
+    }
+
+    for (std::size_t s = 0; s < nSlots; ++s) {
+        if (shards[s].fd >= 0) closeShard(shards[s], val);
+        for (unsigned b = 0; b < ReadsPerShard; ++b) std::free(shards[s].bufs[b]);
+    }
+    delete[] shards;
+
+    return loaded;
+}
+
+bool ShardLoader::drain(IoUring &ring, ShardLoader::Shard shards[], const std::size_t nSlots)
+{
+    // Reap every read still owned by the kernel, so that the buffers can be freed. Unsubmitted reads go out with
+    // the next io_uring_enter and are reaped the same way.
+    std::size_t nInFlight = 0;
+    for (std::size_t s = 0; s < nSlots; ++s) {
+        shards[s].failed = true;
+        nInFlight += shards[s].nInFlight;
+    }
+
+    for (;;) {
+        io_uring_cqe cqe;
+        while (ring.peek(cqe)) {
+            --shards[cqe.user_data / ReadsPerShard].nInFlight;
+            --nInFlight;
+        }
+        if (nInFlight == 0) return true;
+
+        if (!ring.submitAndWait(1)) {
+            if ((errno != EAGAIN) && (errno != EBUSY)) return false;
+            sched_yield();
+        }
+    }
+}
+
+bool ShardLoader::startShard(IoUring &ring, ShardLoader::Shard &shard, const unsigned long long shardIdx,
+                             const char *const paths[], const std::size_t n, HashTable *const tables[],
+                             KeyArena *const arenas[], const ShardLoader::String &val, std::size_t &nextPath,
+                             bool &loaded)
+{
+    for (; nextPath < n; ++nextPath) {
+        if (!openShard(shard, paths[nextPath], tables[nextPath], arenas[nextPath])) {
+            loaded = false;
+            continue;
+        }
+
+        submitReads(ring, shard, shardIdx);
+        if (shard.nInFlight != 0) {
+            ++nextPath;
+            return true;
+        }
+
+        // Nothing to wait for: the file is empty or its first read could not be queued.
+        if (shard.failed) loaded = false;
+        closeShard(shard, val);
+    }
+
+    return false;
+}
+
+bool ShardLoader::openShard(ShardLoader::Shard &shard, const char *const path, HashTable *const table,
+                            KeyArena *const arena)
+{
+    shard.fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (shard.fd < 0) return false;
+
+    struct stat st;
+    if (fstat(shard.fd, &st) != 0) {
+        ::close(shard.fd);
+        shard.fd = -1;
+        return false;
+    }
+
+    shard.table = table;
+    shard.arena = arena;
+    shard.loader.begin(*table);
+
+    shard.fileSize = st.st_size;
+    shard.nextOffset = 0;
+    shard.nSubmitted = 0;
+    shard.nParsed = 0;
+    shard.nInFlight = 0;
+    shard.failed = false;
+
+    return true;
+}
+
+void ShardLoader::closeShard(ShardLoader::Shard &shard, const ShardLoader::String &val)
+{
+    shard.loader.finish(*shard.table, *shard.arena, val);
+    nLines_ += shard.loader.nLines();
+
+    ::close(shard.fd);
+    shard.fd = -1;
+}
+
+void ShardLoader::submitReads(IoUring &ring, ShardLoader::Shard &shard, const unsigned long long shardIdx)
+{
+    while (!shard.failed && (shard.nSubmitted - shard.nParsed < ReadsPerShard) &&
+           (shard.nextOffset < shard.fileSize)) {
+        const unsigned slot = shard.nSubmitted % ReadsPerShard;
+        const unsigned long long left = shard.fileSize - shard.nextOffset;
+
+        shard.offsets[slot] = shard.nextOffset;
+        shard.wants[slot] = static_cast<unsigned>((left < blockSize_) ? left : blockSize_);
+        shard.filled[slot] = 0;
+        shard.ready[slot] = false;
+
+        shard.nextOffset += shard.wants[slot];
+        ++shard.nSubmitted;
+        submitRead(ring, shard, shardIdx, slot);
+    }
+}
+
+void ShardLoader::submitRead(IoUring &ring, ShardLoader::Shard &shard, const unsigned long long shardIdx,
+                             const unsigned slot)
+{
+    const unsigned filled = shard.filled[slot];
+    if (!ring.prepRead(shard.fd, shard.bufs[slot] + filled, shard.wants[slot] - filled, shard.offsets[slot] + filled,
+                       shardIdx * ReadsPerShard + slot)) {
+        shard.failed = true;
+        return;
+    }
+
+    ++shard.nInFlight;
+}
+
+void ShardLoader::complete(IoUring &ring, ShardLoader::Shard &shard, const unsigned long long shardIdx,
+                           const unsigned slot, const int res, const ShardLoader::String &val)
+{
+    --shard.nInFlight;
+    if (shard.failed) return;
+
+    if ((res == -EINTR) || (res == -EAGAIN)) {
+        submitRead(ring, shard, shardIdx, slot);
+        return;
+    }
+    if (res < 0) {
+        shard.failed = true;
+        return;
+    }
+
+    if (res == 0) {
+        // The file shrank since fstat: stop at what was read.
+        shard.wants[slot] = shard.filled[slot];
+        shard.fileSize = shard.offsets[slot] + shard.filled[slot];
+    } else {
+        shard.filled[slot] += static_cast<unsigned>(res);
+        if (shard.filled[slot] < shard.wants[slot]) {
+            submitRead(ring, shard, shardIdx, slot);
+            return;
+        }
+    }
+    shard.ready[slot] = true;
+
+    // Completions arrive in any order, but blocks must reach the splitter in file order.
+    while ((shard.nParsed < shard.nSubmitted) && shard.ready[shard.nParsed % ReadsPerShard]) {
+        const unsigned parsed = shard.nParsed % ReadsPerShard;
+        shard.loader.feed(shard.bufs[parsed], shard.filled[parsed], *shard.table, *shard.arena, val);
+        shard.ready[parsed] = false;
+        ++shard.nParsed;
+
+        submitReads(ring, shard, shardIdx);
+    }
+}
+
+bool ShardLoader::loadThreaded(const char *const paths[], const std::size_t n, HashTable *const tables[],
+                               KeyArena *const arenas[], const ShardLoader::String &val, const unsigned nThreads)
+{
+    std::size_t nWorkers = (nThreads == 0) ? 1 : nThreads;
+    if (nWorkers > n) nWorkers = n;
+
+    std::atomic<std::size_t> nextPath{0};
+    std::atomic<std::size_t> nLines{0};
+    std::atomic<bool> loaded{true};
+
+    auto threads = new std::thread[nWorkers];
+    for (std::size_t t = 0; t < nWorkers; ++t) {
+        threads[t] = std::thread([&] {
+            StreamLoader loader{blockSize_};
+            auto buf = static_cast<char *>(std::malloc(blockSize_));
+
+            for (std::size_t i = nextPath.fetch_add(1); i < n; i = nextPath.fetch_add(1)) {
+                const int fd = ::open(paths[i], O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    loaded.store(false);
+                    continue;
+                }
+                posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+                if (!preadShard(fd, buf, loader, *tables[i], *arenas[i], val)) loaded.store(false);
+                nLines.fetch_add(loader.nLines());
+
+                ::close(fd);
+            }
+
+            std::free(buf);
+        });
+    }
+    for (std::size_t t = 0; t < nWorkers; ++t) threads[t].join();
+    delete[] threads;
+
+    nLines_ = nLines.load();
+
+    return loaded.load();
+}
+
+bool ShardLoader::preadShard(const int fd, char *const buf, StreamLoader &loader, HashTable &table, KeyArena &arena,
+                             const ShardLoader::String &val) const
+{
+    if (!loader.begin(table)) return false;
+
+    // Like a failed io_uring shard, a read error keeps the lines parsed so far.
+    bool read = true;
+    for (off_t offset = 0;;) {
+        const ssize_t n = pread(fd, buf, blockSize_, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            read = false;
+            break;
+        }
+        if (n == 0) break;
+
+        loader.feed(buf, static_cast<std::size_t>(n), table, arena, val);
+        offset += n;
+    }
+    loader.finish(table, arena, val);
+
+    return read;
+}
+
+std::size_t ShardLoader::nLines() const
+{
+    return nLines_;
+}
+
+bool ShardLoader::usedIoUring() const
+{
+    return usedIoUring_;
+}
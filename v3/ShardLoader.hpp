@@ -0,0 +1,101 @@
+#ifndef SHARDLOADER_HPP
+#define SHARDLOADER_HPP
+
+#include <cstddef>
+
+#include <linux/io_uring.h>
+
+#include "HashTable.hpp"
+#include "KeyArena.hpp"
+#include "StreamLoader.hpp"
+
+class IoUring {
+public:
+    IoUring() = default;
+
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    ~IoUring();
+
+    bool open(unsigned entries);
+    void close();
+
+    bool prepRead(int fd, void *buf, unsigned len, unsigned long long offset, unsigned long long userData);
+    bool submitAndWait(unsigned minComplete);
+    bool peek(io_uring_cqe &cqe);
+
+private:
+    int fd_{-1};
+    unsigned nPending_{};
+
+    void *sqRing_{};
+    std::size_t sqRingSize_{};
+    void *cqRing_{};
+    std::size_t cqRingSize_{};
+    io_uring_sqe *sqes_{};
+    std::size_t sqesSize_{};
+
+    unsigned *sqHead_{};
+    unsigned *sqTail_{};
+    unsigned sqMask_{};
+    unsigned *sqArray_{};
+
+    unsigned *cqHead_{};
+    unsigned *cqTail_{};
+    unsigned cqMask_{};
+    io_uring_cqe *cqes_{};
+};
+
+class ShardLoader {
+public:
+    typedef HashTable::String String;
+
+    static const std::size_t DefaultBlockSize = 1 << 20;
+
+    explicit ShardLoader(std::size_t blockSize = DefaultBlockSize, bool useIoUring = true);
+
+    ShardLoader(const ShardLoader &) = delete;
+    ShardLoader &operator=(const ShardLoader &) = delete;
+
+    ~ShardLoader() = default;
+
+    // Every shard needs its own table, as the threaded pread(2) fallback fills them concurrently.
+    bool load(const char *const paths[], std::size_t n, HashTable *const tables[], KeyArena *const arenas[],
+              const String &val, unsigned nThreads = 1);
+
+    std::size_t nLines() const;
+    bool usedIoUring() const;
+
+private:
+    static const unsigned ReadsPerShard = 2;
+    static const unsigned MaxActiveShards = 16;
+
+    struct Shard;
+
+    bool loadIoUring(IoUring &ring, const char *const paths[], std::size_t n, HashTable *const tables[],
+                     KeyArena *const arenas[], const String &val);
+    bool loadThreaded(const char *const paths[], std::size_t n, HashTable *const tables[], KeyArena *const arenas[],
+                      const String &val, unsigned nThreads);
+
+    bool drain(IoUring &ring, Shard shards[], std::size_t nSlots);
+    bool preadShard(int fd, char *buf, StreamLoader &loader, HashTable &table, KeyArena &arena,
+                    const String &val) const;
+
+    bool startShard(IoUring &ring, Shard &shard, unsigned long long shardIdx, const char *const paths[], std::size_t n,
+                    HashTable *const tables[], KeyArena *const arenas[], const String &val, std::size_t &nextPath,
+                    bool &loaded);
+    bool openShard(Shard &shard, const char *path, HashTable *table, KeyArena *arena);
+    void closeShard(Shard &shard, const String &val);
+    void submitReads(IoUring &ring, Shard &shard, unsigned long long shardIdx);
+    void submitRead(IoUring &ring, Shard &shard, unsigned long long shardIdx, unsigned slot);
+    void complete(IoUring &ring, Shard &shard, unsigned long long shardIdx, unsigned slot, int res,
+                  const String &val);
+
+    std::size_t blockSize_;
+    bool useIoUring_;
+    bool usedIoUring_{};
+    std::size_t nLines_{};
+};
+
+#endif /* SHARDLOADER_HPP */
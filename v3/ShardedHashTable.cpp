@@ -0,0 +1,99 @@
+#include "ShardedHashTable.hpp"
+
+#include "Mix.hpp"
+
+ShardedHashTable::ShardedHashTable(unsigned long long (*const hashFunc)(const ShardedHashTable::String &),
+                                   const std::size_t nShards)
+: shards_(nullptr), nShards_((nShards == 0) ? 1 : nShards), hashFunc_(hashFunc)
+{
+    shards_ = new Shard[nShards_];
+    for (std::size_t i = 0; i < nShards_; ++i) {
+        shards_[i].table = new HashTable{hashFunc};
+        shards_[i].owned.store(false, std::memory_order_relaxed);
+    }
+}
+
+ShardedHashTable::~ShardedHashTable()
+{
+    for (std::size_t i = 0; i < nShards_; ++i) delete shards_[i].table;
+    delete[] shards_;
+}
+
+std::size_t ShardedHashTable::nShards() const
+{
+    return nShards_;
+}
+
+std::size_t ShardedHashTable::shardIdx(const ShardedHashTable::String &key) const
+{
+    // Inside a shard, tagOf() takes bits 24..31 of the hash and the bucket is hash % 1009. Routing on the raw hash
+    // would make every key in a shard share those bits, so the shard comes from a remix of the full hash instead.
+    return static_cast<std::size_t>(((mix64(hashFunc_(key)) >> 32) * nShards_) >> 32);
+}
+
+HashTable &ShardedHashTable::shard(const std::size_t idx)
+{
+    return *shards_[idx].table;
+}
+
+const HashTable &ShardedHashTable::shard(const std::size_t idx) const
+{
+    return *shards_[idx].table;
+}
+
+HashTable *ShardedHashTable::acquireShard(const std::size_t idx)
+{
+    bool owned = false;
+    if (!shards_[idx].owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) return nullptr;
+
+    return shards_[idx].table;
+}
+
+void ShardedHashTable::releaseShard(const std::size_t idx)
+{
+    shards_[idx].owned.store(false, std::memory_order_release);
+}
+
+void ShardedHashTable::route(const ShardedHashTable::String *const keys[], const std::size_t n,
+                             std::size_t shardStarts[], std::size_t order[]) const
+{
+    for (std::size_t s = 0; s <= nShards_; ++s) shardStarts[s] = 0;
+
+    auto keyShards = new std::size_t[n];
+    for (std::size_t i = 0; i < n; ++i) {
+        keyShards[i] = shardIdx(*keys[i]);
+        ++shardStarts[keyShards[i] + 1];
+    }
+    for (std::size_t s = 0; s < nShards_; ++s) shardStarts[s + 1] += shardStarts[s];
+
+    auto shardFill = new std::size_t[nShards_]{};
+    for (std::size_t i = 0; i < n; ++i) order[shardStarts[keyShards[i]] + shardFill[keyShards[i]]++] = i;
+
+    delete[] shardFill;
+    delete[] keyShards;
+}
+
+void ShardedHashTable::insert(const ShardedHashTable::Entry &entry)
+{
+    insert(*entry.key, *entry.val);
+}
+
+void ShardedHashTable::insert(const ShardedHashTable::String &key, const ShardedHashTable::String &val)
+{
+    shards_[shardIdx(key)].table->insert(key, val);
+}
+
+bool ShardedHashTable::remove(const ShardedHashTable::String &key)
+{
+    return shards_[shardIdx(key)].table->remove(key);
+}
+
+const ShardedHashTable::String *ShardedHashTable::find(const ShardedHashTable::String &key) const
+{
+    return shards_[shardIdx(key)].table->find(key);
+}
+
+void ShardedHashTable::clear()
+{
+    for (std::size_t i = 0; i < nShards_; ++i) shards_[i].table->clear();
+}
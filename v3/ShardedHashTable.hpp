@@ -0,0 +1,52 @@
+#ifndef SHARDEDHASHTABLE_HPP
+#define SHARDEDHASHTABLE_HPP
+
+#include <atomic>
+
+#include "HashTable.hpp"
+
+class ShardedHashTable {
+public:
+    typedef HashTable::String String;
+    typedef HashTable::Entry Entry;
+
+    ShardedHashTable() = delete;
+    ShardedHashTable(unsigned long long (*hashFunc)(const String &), std::size_t nShards);
+
+    ShardedHashTable(const ShardedHashTable &) = delete;
+    ShardedHashTable &operator=(const ShardedHashTable &) = delete;
+
+    ~ShardedHashTable();
+
+    std::size_t nShards() const;
+    std::size_t shardIdx(const String &key) const;
+
+    HashTable &shard(std::size_t idx);
+    const HashTable &shard(std::size_t idx) const;
+
+    HashTable *acquireShard(std::size_t idx);
+    void releaseShard(std::size_t idx);
+
+    void route(const String *const keys[], std::size_t n, std::size_t shardStarts[], std::size_t order[]) const;
+
+    void insert(const Entry &entry);
+    void insert(const String &key, const String &val);
+    bool remove(const String &key);
+    const String *find(const String &key) const;
+
+    void clear();
+
+private:
+    struct alignas(64) Shard {
+        HashTable *table;
+        std::atomic<bool> owned;
+    };
+
+
+    Shard *shards_;
+    std::size_t nShards_;
+
+    unsigned long long (*hashFunc_)(const String &);
+};
+
+#endif /* SHARDEDHASHTABLE_HPP */
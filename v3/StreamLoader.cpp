@@ -0,0 +1,160 @@
+#include "StreamLoader.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+StreamLoader::StreamLoader(const std::size_t blockSize)
+: block_(nullptr), blockSize_((blockSize == 0) ? DefaultBlockSize : blockSize), carry_{}, carryLen_(0),
+  batch_(nullptr), batchSize_(0), nLines_(0), fed_(false)
+{
+    batch_ = static_cast<String *>(std::aligned_alloc(sizeof(String), BatchKeys * sizeof(String)));
+}
+
+StreamLoader::~StreamLoader()
+{
+    std::free(batch_);
+    std::free(block_);
+}
+
+long StreamLoader::readFd(void *const ctx, char *const buf, const std::size_t size)
+{
+    const int fd = *static_cast<const int *>(ctx);
+
+    for (;;) {
+        const ssize_t n = read(fd, buf, size);
+        if ((n >= 0) || (errno != EINTR)) return n;
+    }
+}
+
+long StreamLoader::readStream(void *const ctx, char *const buf, const std::size_t size)
+{
+    auto &stream = *static_cast<std::istream *>(ctx);
+
+    stream.read(buf, static_cast<std::streamsize>(size));
+    if (stream.bad()) return -1;
+
+    return stream.gcount();
+}
+
+bool StreamLoader::ingest(int fd, HashTable &table, KeyArena &arena, const StreamLoader::String &val)
+{
+    return ingest(readFd, &fd, table, arena, val);
+}
+
+bool StreamLoader::ingest(std::istream &stream, HashTable &table, KeyArena &arena, const StreamLoader::String &val)
+{
+    return ingest(readStream, &stream, table, arena, val);
+}
+
+bool StreamLoader::ingest(const StreamLoader::ReadFunc read, void *const ctx, HashTable &table, KeyArena &arena,
+                          const StreamLoader::String &val)
+{
+    if (!begin(table)) return false;
+
+    if (block_ == nullptr) block_ = static_cast<char *>(std::malloc(blockSize_));
+
+    for (;;) {
+        const long n = read(ctx, block_, blockSize_);
+        if (n < 0) {
+            flush(table, arena, val);
+            return false;
+        }
+        if (n == 0) break;
+
+        feed(block_, n, table, arena, val);
+    }
+
+    finish(table, arena, val);
+
+    return true;
+}
+
+bool StreamLoader::begin(const HashTable &table)
+{
+    nLines_ = 0;
+    batchSize_ = 0;
+    std::memset(carry_, 0, sizeof(carry_));
+    carryLen_ = 0;
+    fed_ = false;
+
+    return !table.frozen();
+}
+
+void StreamLoader::feed(const char *const block, const std::size_t size, HashTable &table, KeyArena &arena,
+                        const StreamLoader::String &val)
+{
+    if (size == 0) return;
+    fed_ = true;
+
+    splitter_.split(block, size, false);
+
+    std::size_t tailStart = 0;
+    for (std::size_t i = 0; i < splitter_.size(); ++i) {
+        const char *const line = block + splitter_.offset(i);
+        const std::size_t len = splitter_.length(i);
+
+        if ((i == 0) && (carryLen_ != 0)) {
+            appendCarry(line, len);
+            addLine(carry_, carryLen_, carry_ + sizeof(carry_), table, arena, val);
+            std::memset(carry_, 0, sizeof(carry_));
+            carryLen_ = 0;
+        } else {
+            addLine(line, len, block + size, table, arena, val);
+        }
+
+        tailStart = splitter_.offset(i) + len + 1;
+    }
+
+    appendCarry(block + tailStart, size - tailStart);
+}
+
+void StreamLoader::finish(HashTable &table, KeyArena &arena, const StreamLoader::String &val)
+{
+    if (fed_) addLine(carry_, carryLen_, carry_ + sizeof(carry_), table, arena, val);
+    flush(table, arena, val);
+
+    fed_ = false;
+}
+
+void StreamLoader::appendCarry(const char *const src, const std::size_t len)
+{
+    if (carryLen_ < HashTable::StringSize - 1) {
+        const std::size_t room = HashTable::StringSize - 1 - carryLen_;
+        std::memcpy(carry_ + carryLen_, src, (len < room) ? len : room);
+    }
+
+    carryLen_ += len;
+}
+
+void StreamLoader::addLine(const char *const src, const std::size_t len, const char *const srcEnd, HashTable &table,
+                           KeyArena &arena, const StreamLoader::String &val)
+{
+    LineSplitter::copyKey(batch_[batchSize_++], src, len, srcEnd);
+    ++nLines_;
+
+    if (batchSize_ == BatchKeys) flush(table, arena, val);
+}
+
+void StreamLoader::flush(HashTable &table, KeyArena &arena, const StreamLoader::String &val)
+{
+    // Each key is staged in an arena slot and inserted straight from it. A duplicate, whether already in the table
+    // or earlier in this batch, is rejected by insert() and leaves the slot free for the next key.
+    String *slot = nullptr;
+    for (std::size_t i = 0; i < batchSize_; ++i) {
+        if (slot == nullptr) slot = arena.allocate(1);
+
+        std::memcpy(*slot, batch_[i], sizeof(String));
+        if (table.insert(*slot, val)) slot = nullptr;
+    }
+    if (slot != nullptr) arena.release(1);
+
+    batchSize_ = 0;
+}
+
+std::size_t StreamLoader::nLines() const
+{
+    return nLines_;
+}
@@ -0,0 +1,63 @@
+#ifndef STREAMLOADER_HPP
+#define STREAMLOADER_HPP
+
+#include <cstddef>
+#include <istream>
+
+#include "HashTable.hpp"
+#include "KeyArena.hpp"
+#include "LineSplitter.hpp"
+
+class StreamLoader {
+public:
+    typedef HashTable::String String;
+    typedef HashTable::Entry Entry;
+
+    static const std::size_t DefaultBlockSize = 1 << 20;
+
+    explicit StreamLoader(std::size_t blockSize = DefaultBlockSize);
+
+    StreamLoader(const StreamLoader &) = delete;
+    StreamLoader &operator=(const StreamLoader &) = delete;
+
+    ~StreamLoader();
+
+    bool ingest(int fd, HashTable &table, KeyArena &arena, const String &val);
+    bool ingest(std::istream &stream, HashTable &table, KeyArena &arena, const String &val);
+
+    bool begin(const HashTable &table);
+    void feed(const char *block, std::size_t size, HashTable &table, KeyArena &arena, const String &val);
+    void finish(HashTable &table, KeyArena &arena, const String &val);
+
+    std::size_t nLines() const;
+
+private:
+    typedef long (*ReadFunc)(void *ctx, char *buf, std::size_t size);
+
+    static const std::size_t BatchKeys = 4096;
+
+    static long readFd(void *ctx, char *buf, std::size_t size);
+    static long readStream(void *ctx, char *buf, std::size_t size);
+
+    bool ingest(ReadFunc read, void *ctx, HashTable &table, KeyArena &arena, const String &val);
+
+    void appendCarry(const char *src, std::size_t len);
+    void addLine(const char *src, std::size_t len, const char *srcEnd, HashTable &table, KeyArena &arena,
+                 const String &val);
+    void flush(HashTable &table, KeyArena &arena, const String &val);
+
+    char *block_;
+    std::size_t blockSize_;
+    LineSplitter splitter_;
+
+    String carry_;
+    std::size_t carryLen_;
+
+    String *batch_;
+    std::size_t batchSize_;
+
+    std::size_t nLines_;
+    bool fed_;
+};
+
+#endif /* STREAMLOADER_HPP */
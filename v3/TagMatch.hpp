@@ -0,0 +1,32 @@
+#ifndef TAGMATCH_HPP
+#define TAGMATCH_HPP
+
+#include <immintrin.h>
+
+static const unsigned TagBlockSize = 32;
+
+inline unsigned char tagOf(unsigned long long hash)
+{
+    auto tag = static_cast<unsigned char>(hash >> 24);
+
+    return (tag == 0) ? 1 : tag;
+}
+
+inline unsigned matchTags(const unsigned char *tags, unsigned char tag)
+{
+#ifdef __AVX2__
+    const __m256i needle = _mm256_set1_epi8(static_cast<char>(tag));
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(tags));
+
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+#else
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(tag));
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags + 16));
+
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, needle))) |
+           (static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, needle))) << 16);
+#endif
+}
+
+#endif /* TAGMATCH_HPP */
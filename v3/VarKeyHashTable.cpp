@@ -0,0 +1,262 @@
+#include "VarKeyHashTable.hpp"
+
+#include <cstdlib>
+
+#include "Mix.hpp"
+#include "TagMatch.hpp"
+
+ByteArena::ByteArena(const std::size_t chunkSize)
+: chunkSize_((chunkSize == 0) ? 1 : chunkSize)
+{
+}
+
+ByteArena::~ByteArena()
+{
+    clear();
+}
+
+void ByteArena::addChunk(const std::size_t size)
+{
+    if (nChunks_ == chunksCap_) {
+        chunksCap_ = (chunksCap_ == 0) ? 16 : chunksCap_ * 2;
+        chunks_ = static_cast<char **>(std::realloc(chunks_, chunksCap_ * sizeof(*chunks_)));
+    }
+
+    curr_ = static_cast<char *>(std::malloc(size));
+    currUsed_ = 0;
+    currCap_ = size;
+
+    chunks_[nChunks_++] = curr_;
+    nAllocated_ += size;
+}
+
+const char *ByteArena::add(const char *const src, const std::size_t len)
+{
+    if (currCap_ - currUsed_ < len + 1) addChunk((len + 1 > chunkSize_) ? len + 1 : chunkSize_);
+
+    char *dst = curr_ + currUsed_;
+    std::memcpy(dst, src, len);
+    dst[len] = '\0';
+    currUsed_ += len + 1;
+
+    return dst;
+}
+
+void ByteArena::clear()
+{
+    for (std::size_t c = 0; c < nChunks_; ++c) std::free(chunks_[c]);
+    std::free(chunks_);
+
+    chunks_ = nullptr;
+    nChunks_ = 0;
+    chunksCap_ = 0;
+
+    curr_ = nullptr;
+    currUsed_ = 0;
+    currCap_ = 0;
+
+    nAllocated_ = 0;
+}
+
+std::size_t ByteArena::memoryUsage() const
+{
+    return nAllocated_ + chunksCap_ * sizeof(*chunks_);
+}
+
+VarKeyHashTable::VarKeyHashTable()
+{
+    allocate(InitialCapacity);
+}
+
+VarKeyHashTable::~VarKeyHashTable()
+{
+    std::free(slots_);
+    std::free(tags_);
+}
+
+void VarKeyHashTable::allocate(const std::size_t capacity)
+{
+    tags_ = static_cast<unsigned char *>(std::calloc(capacity + TagBlockSize, sizeof(*tags_)));
+    slots_ = static_cast<Entry *>(std::malloc(capacity * sizeof(*slots_)));
+    capacity_ = capacity;
+}
+
+VarKeyHashTable::Entry VarKeyHashTable::probe(const std::string_view key, const unsigned long long hash)
+{
+    Entry entry{};
+
+    entry.len = static_cast<unsigned>(key.size());
+    if (entry.isInline()) {
+        std::memcpy(entry.bytes, key.data(), key.size());
+    } else {
+        entry.ext.ptr = key.data();
+        entry.ext.hash = hash;
+    }
+
+    return entry;
+}
+
+unsigned long long VarKeyHashTable::hashOf(const VarKeyHashTable::Entry &entry)
+{
+    return entry.isInline() ? varKeyHash(std::string_view{entry.bytes, entry.len}) : entry.ext.hash;
+}
+
+unsigned char VarKeyHashTable::tagOfHash(const unsigned long long hash)
+{
+    return tagOf(hash >> 32);
+}
+
+void VarKeyHashTable::setTag(const std::size_t slot, const unsigned char tag)
+{
+    tags_[slot] = tag;
+    if (slot < TagBlockSize) tags_[capacity_ + slot] = tag;
+}
+
+std::size_t VarKeyHashTable::findSlot(const VarKeyHashTable::Entry &entry, const unsigned long long hash) const
+{
+    const std::size_t mask = capacity_ - 1;
+    const unsigned char tag = tagOfHash(hash);
+
+    for (std::size_t pos = hash & mask;; pos = (pos + TagBlockSize) & mask) {
+        const unsigned empties = matchTags(tags_ + pos, 0);
+        unsigned matches = matchTags(tags_ + pos, tag);
+        if (empties != 0) matches &= (empties & -empties) - 1;
+
+        while (matches != 0) {
+            const std::size_t slot = (pos + __builtin_ctz(matches)) & mask;
+            if (slots_[slot] == entry) return slot;
+            matches &= matches - 1;
+        }
+
+        if (empties != 0) return capacity_;
+    }
+}
+
+void VarKeyHashTable::insertSlot(const VarKeyHashTable::Entry &entry, const unsigned long long hash)
+{
+    const std::size_t mask = capacity_ - 1;
+
+    for (std::size_t pos = hash & mask;; pos = (pos + TagBlockSize) & mask) {
+        const unsigned empties = matchTags(tags_ + pos, 0);
+        if (empties == 0) continue;
+
+        const std::size_t slot = (pos + __builtin_ctz(empties)) & mask;
+        slots_[slot] = entry;
+        setTag(slot, tagOfHash(hash));
+
+        return;
+    }
+}
+
+void VarKeyHashTable::resize()
+{
+    unsigned char *const oldTags = tags_;
+    Entry *const oldSlots = slots_;
+    const std::size_t oldCapacity = capacity_;
+
+    allocate(oldCapacity * 2);
+    for (std::size_t slot = 0; slot < oldCapacity; ++slot) {
+        if (oldTags[slot] != 0) insertSlot(oldSlots[slot], hashOf(oldSlots[slot]));
+    }
+
+    std::free(oldSlots);
+    std::free(oldTags);
+}
+
+bool VarKeyHashTable::insert(const std::string_view key, const unsigned val)
+{
+    if (key.size() > 0xFFFFFFFFull) return false;
+
+    const unsigned long long hash = varKeyHash(key);
+    Entry entry = probe(key, hash);
+    if (findSlot(entry, hash) != capacity_) return false;
+
+    if (!entry.isInline()) entry.ext.ptr = arena_.add(key.data(), key.size());
+    entry.val = val;
+
+    if ((size_ + 1) * 100 > capacity_ * MaxLoadPercent) resize();
+    insertSlot(entry, hash);
+    ++size_;
+
+    return true;
+}
+
+bool VarKeyHashTable::remove(const std::string_view key)
+{
+    if (key.size() > 0xFFFFFFFFull) return false;
+
+    const unsigned long long hash = varKeyHash(key);
+    std::size_t hole = findSlot(probe(key, hash), hash);
+    if (hole == capacity_) return false;
+
+    // Backward-shift deletion keeps every probe run free of holes, so no tombstones are needed.
+    const std::size_t mask = capacity_ - 1;
+    for (std::size_t slot = (hole + 1) & mask; tags_[slot] != 0; slot = (slot + 1) & mask) {
+        const std::size_t home = hashOf(slots_[slot]) & mask;
+        if (((slot - home) & mask) < ((slot - hole) & mask)) continue;
+
+        slots_[hole] = slots_[slot];
+        setTag(hole, tags_[slot]);
+        hole = slot;
+    }
+    setTag(hole, 0);
+    --size_;
+
+    return true;
+}
+
+const unsigned *VarKeyHashTable::find(const std::string_view key) const
+{
+    if (key.size() > 0xFFFFFFFFull) return nullptr;
+
+    const unsigned long long hash = varKeyHash(key);
+    const std::size_t slot = findSlot(probe(key, hash), hash);
+    if (slot == capacity_) return nullptr;
+
+    return &slots_[slot].val;
+}
+
+void VarKeyHashTable::clear()
+{
+    std::free(slots_);
+    std::free(tags_);
+    allocate(InitialCapacity);
+    size_ = 0;
+
+    arena_.clear();
+}
+
+std::size_t VarKeyHashTable::size() const
+{
+    return size_;
+}
+
+std::size_t VarKeyHashTable::capacity() const
+{
+    return capacity_;
+}
+
+std::size_t VarKeyHashTable::memoryUsage() const
+{
+    return capacity_ * sizeof(*slots_) + (capacity_ + TagBlockSize) * sizeof(*tags_) + arena_.memoryUsage();
+}
+
+unsigned long long varKeyHash(const std::string_view key)
+{
+    const char *src = key.data();
+    std::size_t len = key.size();
+
+    // Multiply-xorshift over 8-byte words, with the zero-padded tail as a last word, then a full avalanche.
+    unsigned long long hash = 0x9E3779B97F4A7C15ull ^ len;
+    for (; len != 0; src += sizeof(unsigned long long)) {
+        const std::size_t n = (len < sizeof(unsigned long long)) ? len : sizeof(unsigned long long);
+        unsigned long long word = 0;
+        std::memcpy(&word, src, n);
+        len -= n;
+
+        hash = (hash ^ word) * 0xC4CEB9FE1A85EC53ull;
+        hash ^= hash >> 29;
+    }
+
+    return mix64(hash);
+}
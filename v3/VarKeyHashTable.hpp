@@ -0,0 +1,116 @@
+#ifndef VARKEYHASHTABLE_HPP
+#define VARKEYHASHTABLE_HPP
+
+#include <cstddef>
+#include <cstring>
+
+#include <string_view>
+
+class ByteArena {
+public:
+    static const std::size_t DefaultChunkSize = 1 << 16;
+
+    explicit ByteArena(std::size_t chunkSize = DefaultChunkSize);
+
+    ByteArena(const ByteArena &) = delete;
+    ByteArena &operator=(const ByteArena &) = delete;
+
+    ~ByteArena();
+
+    const char *add(const char *src, std::size_t len);
+    void clear();
+
+    std::size_t memoryUsage() const;
+
+private:
+    void addChunk(std::size_t size);
+
+    char **chunks_{};
+    std::size_t nChunks_{};
+    std::size_t chunksCap_{};
+
+    char *curr_{};
+    std::size_t currUsed_{};
+    std::size_t currCap_{};
+
+    std::size_t chunkSize_;
+    std::size_t nAllocated_{};
+};
+
+class VarKeyHashTable {
+public:
+    static const std::size_t InlineKeySize = 15;
+
+    VarKeyHashTable();
+
+    VarKeyHashTable(const VarKeyHashTable &) = delete;
+    VarKeyHashTable &operator=(const VarKeyHashTable &) = delete;
+
+    ~VarKeyHashTable();
+
+    // Values are 32-bit payloads, typically indexes into a caller-owned array.
+    bool insert(std::string_view key, unsigned val);
+    bool remove(std::string_view key);
+    // Points into the table and stays valid until the next insert or remove.
+    const unsigned *find(std::string_view key) const;
+
+    void clear();
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+    std::size_t memoryUsage() const;
+
+private:
+    // Keys of up to InlineKeySize bytes live zero-padded in the entry and are rehashed when needed. Longer keys
+    // live in the arena, and the entry caches their hash next to the pointer.
+    struct Entry {
+        union {
+            char bytes[InlineKeySize + 1];
+            struct {
+                const char *ptr;
+                unsigned long long hash;
+            } ext;
+        };
+        unsigned len;
+        unsigned val;
+
+        bool isInline() const
+        {
+            return len <= InlineKeySize;
+        }
+
+        friend bool operator==(const Entry &a, const Entry &b)
+        {
+            if (a.len != b.len) return false;
+            if (a.isInline()) return std::memcmp(a.bytes, b.bytes, sizeof(a.bytes)) == 0;
+
+            return (a.ext.hash == b.ext.hash) && (std::memcmp(a.ext.ptr, b.ext.ptr, a.len) == 0);
+        }
+    };
+
+    static const std::size_t InitialCapacity = 64;
+    static const std::size_t MaxLoadPercent = 87;
+
+    static Entry probe(std::string_view key, unsigned long long hash);
+    static unsigned long long hashOf(const Entry &entry);
+    // The slot comes from the low bits of the hash and the tag from the top byte, so the two never overlap.
+    static unsigned char tagOfHash(unsigned long long hash);
+
+    void allocate(std::size_t capacity);
+    void setTag(std::size_t slot, unsigned char tag);
+    std::size_t findSlot(const Entry &entry, unsigned long long hash) const;
+    void insertSlot(const Entry &entry, unsigned long long hash);
+    void resize();
+
+    // Linear probing over tag windows; the last TagBlockSize tags mirror the first ones.
+    unsigned char *tags_{};
+    Entry *slots_{};
+    std::size_t capacity_{};
+    std::size_t size_{};
+
+    ByteArena arena_;
+};
+
+unsigned long long varKeyHash(std::string_view key);
+
+#endif /* VARKEYHASHTABLE_HPP */
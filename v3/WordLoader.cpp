@@ -0,0 +1,140 @@
+#include "WordLoader.hpp"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <thread>
+
+#include "LineSplitter.hpp"
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const char *const path)
+{
+    close();
+
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat buf{};
+    if (fstat(fd, &buf) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_ = buf.st_size;
+    if (size_ != 0) {
+        void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (data == MAP_FAILED) {
+            size_ = 0;
+            ::close(fd);
+            return false;
+        }
+
+        madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(data);
+    }
+    ::close(fd);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data_ != nullptr) munmap(const_cast<char *>(data_), size_);
+
+    data_ = nullptr;
+    size_ = 0;
+}
+
+const char *MappedFile::data() const
+{
+    return data_;
+}
+
+std::size_t MappedFile::size() const
+{
+    return size_;
+}
+
+WordList::~WordList()
+{
+    clear();
+}
+
+bool WordList::load(const char *const path, const unsigned nThreads)
+{
+    clear();
+
+    MappedFile file;
+    if (!file.open(path)) return false;
+    if (file.size() == 0) return true;
+
+    const unsigned nChunks = (nThreads == 0) ? 1 : nThreads;
+    const char *const data = file.data();
+
+    auto chunkStarts = new std::size_t[nChunks + 1];
+    chunkStarts[0] = 0;
+    for (unsigned c = 1; c < nChunks; ++c) {
+        const std::size_t pos = file.size() * c / nChunks;
+        const std::size_t prev = chunkStarts[c - 1];
+        auto newline = (pos > prev) ? static_cast<const char *>(memrchr(data + prev, '\n', pos - prev)) : nullptr;
+        chunkStarts[c] = (newline == nullptr) ? prev : newline + 1 - data;
+    }
+    chunkStarts[nChunks] = file.size();
+
+    auto splitters = new LineSplitter[nChunks];
+    auto threads = new std::thread[nChunks];
+    for (unsigned c = 0; c < nChunks; ++c) {
+        threads[c] = std::thread([&, c] {
+            splitters[c].split(data + chunkStarts[c], chunkStarts[c + 1] - chunkStarts[c], c == nChunks - 1);
+        });
+    }
+    for (unsigned c = 0; c < nChunks; ++c) threads[c].join();
+
+    auto wordStarts = new std::size_t[nChunks];
+    for (unsigned c = 0; c < nChunks; ++c) {
+        wordStarts[c] = nWords_;
+        nWords_ += splitters[c].size();
+    }
+    words_ = arena_.allocate(nWords_);
+
+    for (unsigned c = 0; c < nChunks; ++c) {
+        threads[c] = std::thread([&, c] {
+            splitters[c].copyKeys(data + chunkStarts[c], chunkStarts[c + 1] - chunkStarts[c], words_ + wordStarts[c]);
+        });
+    }
+    for (unsigned c = 0; c < nChunks; ++c) threads[c].join();
+
+    delete[] wordStarts;
+    delete[] threads;
+    delete[] splitters;
+    delete[] chunkStarts;
+
+    return true;
+}
+
+void WordList::clear()
+{
+    arena_.clear();
+
+    words_ = nullptr;
+    nWords_ = 0;
+}
+
+std::size_t WordList::size() const
+{
+    return nWords_;
+}
+
+const WordList::String &WordList::operator[](const std::size_t idx) const
+{
+    return words_[idx];
+}
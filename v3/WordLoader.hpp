@@ -0,0 +1,52 @@
+#ifndef WORDLOADER_HPP
+#define WORDLOADER_HPP
+
+#include <cstddef>
+
+#include "HashTable.hpp"
+#include "KeyArena.hpp"
+
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile();
+
+    bool open(const char *path);
+    void close();
+
+    const char *data() const;
+    std::size_t size() const;
+
+private:
+    const char *data_{};
+    std::size_t size_{};
+};
+
+class WordList {
+public:
+    typedef HashTable::String String;
+
+    WordList() = default;
+
+    WordList(const WordList &) = delete;
+    WordList &operator=(const WordList &) = delete;
+
+    ~WordList();
+
+    bool load(const char *path, unsigned nThreads = 1);
+    void clear();
+
+    std::size_t size() const;
+    const String &operator[](std::size_t idx) const;
+
+private:
+    KeyArena arena_;
+    String *words_{};
+    std::size_t nWords_{};
+};
+
+#endif /* WORDLOADER_HPP */
@@ -0,0 +1,162 @@
+#include "WorkStealingPool.hpp"
+
+#include <cstdlib>
+#include <immintrin.h>
+
+WorkStealingPool::WorkStealingPool(const unsigned nThreads)
+: deques_(nullptr), workers_(nullptr), nThreads_((nThreads == 0) ? 1 : nThreads)
+{
+    deques_ = new Deque[nThreads_]{};
+    workers_ = new std::thread[nThreads_];
+
+    for (unsigned self = 1; self < nThreads_; ++self) workers_[self] = std::thread([this, self] { workerLoop(self); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stop_ = true;
+    }
+    wakeCond_.notify_all();
+
+    for (unsigned self = 1; self < nThreads_; ++self) workers_[self].join();
+
+    for (unsigned self = 0; self < nThreads_; ++self) std::free(deques_[self].tasks);
+    delete[] workers_;
+    delete[] deques_;
+}
+
+unsigned WorkStealingPool::nThreads() const
+{
+    return nThreads_;
+}
+
+void WorkStealingPool::reserve(WorkStealingPool::Deque &deque, const std::size_t cap)
+{
+    if (deque.cap >= cap) return;
+
+    auto tasks = static_cast<Task *>(std::malloc(cap * sizeof(Task)));
+    for (std::size_t i = 0; i < deque.size; ++i) tasks[i] = deque.tasks[(deque.head + i) % deque.cap];
+
+    std::free(deque.tasks);
+    deque.tasks = tasks;
+    deque.cap = cap;
+    deque.head = 0;
+}
+
+void WorkStealingPool::parallelFor(const std::size_t n, const std::size_t grain, const WorkStealingPool::TaskFunc func,
+                                   void *const ctx)
+{
+    if (n == 0) return;
+
+    std::lock_guard<std::mutex> submitLock(submitMutex_);
+
+    const std::size_t chunk = (grain == 0) ? 1 : grain;
+    const std::size_t nTasks = (n + chunk - 1) / chunk;
+    pending_.store(nTasks, std::memory_order_relaxed);
+
+    for (unsigned self = 0; self < nThreads_; ++self) {
+        Deque &deque = deques_[self];
+        deque.lock.lock();
+        reserve(deque, nTasks);
+        for (std::size_t t = nTasks * self / nThreads_; t < nTasks * (self + 1) / nThreads_; ++t) {
+            const std::size_t end = (t + 1) * chunk;
+            deque.tasks[(deque.head + deque.size++) % deque.cap] = Task{
+                .func = func, .ctx = ctx, .begin = t * chunk, .end = (end < n) ? end : n};
+        }
+        deque.lock.unlock();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        ++generation_;
+    }
+    wakeCond_.notify_all();
+
+    unsigned long long rng = reinterpret_cast<unsigned long long>(this);
+    while (pending_.load(std::memory_order_acquire) != 0) {
+        if (!runOne(0, rng)) _mm_pause();
+    }
+}
+
+bool WorkStealingPool::popLocal(const unsigned self, WorkStealingPool::Task &task)
+{
+    Deque &deque = deques_[self];
+
+    deque.lock.lock();
+    const bool popped = deque.size != 0;
+    if (popped) task = deque.tasks[(deque.head + --deque.size) % deque.cap];
+    deque.lock.unlock();
+
+    return popped;
+}
+
+bool WorkStealingPool::stealHalf(const unsigned self, unsigned long long &rng, WorkStealingPool::Task &task)
+{
+    if (nThreads_ == 1) return false;
+
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    const unsigned start = static_cast<unsigned>(rng % nThreads_);
+
+    for (unsigned i = 0; i < nThreads_; ++i) {
+        const unsigned victim = (start + i) % nThreads_;
+        if (victim == self) continue;
+
+        Deque &first = deques_[(self < victim) ? self : victim];
+        Deque &second = deques_[(self < victim) ? victim : self];
+        Deque &from = deques_[victim];
+        Deque &to = deques_[self];
+
+        first.lock.lock();
+        second.lock.lock();
+        const std::size_t nStolen = (from.size + 1) / 2;
+        if (nStolen != 0) {
+            reserve(to, to.size + nStolen);
+            for (std::size_t s = 0; s < nStolen; ++s) {
+                to.tasks[(to.head + to.size++) % to.cap] = from.tasks[from.head];
+                from.head = (from.head + 1) % from.cap;
+                --from.size;
+            }
+            task = to.tasks[(to.head + --to.size) % to.cap];
+        }
+        second.lock.unlock();
+        first.lock.unlock();
+
+        if (nStolen != 0) return true;
+    }
+
+    return false;
+}
+
+bool WorkStealingPool::runOne(const unsigned self, unsigned long long &rng)
+{
+    Task task{};
+    if (!popLocal(self, task) && !stealHalf(self, rng, task)) return false;
+
+    task.func(task.ctx, task.begin, task.end);
+    pending_.fetch_sub(1, std::memory_order_release);
+
+    return true;
+}
+
+void WorkStealingPool::workerLoop(const unsigned self)
+{
+    unsigned long long rng = 0x9E3779B97F4A7C15ull * (self + 1);
+    unsigned long seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wakeCond_.wait(lock, [&] { return stop_ || (generation_ != seen); });
+            if (stop_) return;
+            seen = generation_;
+        }
+
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            if (!runOne(self, rng)) _mm_pause();
+        }
+    }
+}
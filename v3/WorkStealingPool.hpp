@@ -0,0 +1,65 @@
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+#include "RwSpinLock.hpp"
+
+class WorkStealingPool {
+public:
+    typedef void (*TaskFunc)(void *ctx, std::size_t begin, std::size_t end);
+
+    WorkStealingPool() = delete;
+    explicit WorkStealingPool(unsigned nThreads);
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    ~WorkStealingPool();
+
+    void parallelFor(std::size_t n, std::size_t grain, TaskFunc func, void *ctx);
+
+    unsigned nThreads() const;
+
+private:
+    struct Task {
+        TaskFunc func;
+        void *ctx;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct alignas(64) Deque {
+        RwSpinLock lock;
+        Task *tasks;
+        std::size_t cap;
+        std::size_t head;
+        std::size_t size;
+    };
+
+    static void reserve(Deque &deque, std::size_t cap);
+
+    bool popLocal(unsigned self, Task &task);
+    bool stealHalf(unsigned self, unsigned long long &rng, Task &task);
+    bool runOne(unsigned self, unsigned long long &rng);
+
+    void workerLoop(unsigned self);
+
+    Deque *deques_;
+    std::thread *workers_;
+    unsigned nThreads_;
+
+    std::atomic<std::size_t> pending_{0};
+
+    std::mutex submitMutex_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCond_;
+    unsigned long generation_{};
+    bool stop_{};
+};
+
+#endif /* WORKSTEALINGPOOL_HPP */
@@ -0,0 +1,238 @@
+#include "WriteAheadLog.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <immintrin.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "WordLoader.hpp"
+
+WriteAheadLog::~WriteAheadLog()
+{
+    close();
+}
+
+bool WriteAheadLog::open(const char *const path, const unsigned commitWindowUs)
+{
+    close();
+
+    fd_ = ::open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) return false;
+
+    commitWindowUs_ = commitWindowUs;
+    bufCap_ = FlushThreshold + MaxRecordSize;
+    buf_ = static_cast<unsigned char *>(std::malloc(bufCap_));
+    spare_ = static_cast<unsigned char *>(std::malloc(bufCap_));
+    bufSize_ = 0;
+
+    nextLsn_ = 0;
+    durableLsn_ = 0;
+    urgent_ = false;
+    failed_ = false;
+    stop_ = false;
+
+    flusher_ = std::thread([this] { flusherLoop(); });
+
+    return true;
+}
+
+void WriteAheadLog::close()
+{
+    if (fd_ < 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    flushCond_.notify_one();
+    flusher_.join();
+
+    ::close(fd_);
+    fd_ = -1;
+
+    std::free(buf_);
+    std::free(spare_);
+    buf_ = nullptr;
+    spare_ = nullptr;
+    bufSize_ = 0;
+    bufCap_ = 0;
+}
+
+unsigned WriteAheadLog::recordChecksum(const unsigned char *const record, const std::size_t size)
+{
+    unsigned crc = 0;
+    for (std::size_t i = 0; i < size; ++i) crc = _mm_crc32_u8(crc, record[i]);
+
+    return crc;
+}
+
+unsigned long long WriteAheadLog::append(const WriteAheadLog::RecordType type, const WriteAheadLog::String &key,
+                                         const WriteAheadLog::String *const val)
+{
+    unsigned char record[MaxRecordSize];
+    const std::size_t keyLen = strnlen(key, HashTable::StringSize - 1);
+    const std::size_t valLen = (val == nullptr) ? 0 : strnlen(*val, HashTable::StringSize - 1);
+
+    record[0] = type;
+    record[1] = static_cast<unsigned char>(keyLen);
+    record[2] = static_cast<unsigned char>(valLen);
+    std::memcpy(record + 3, key, keyLen);
+    if (val != nullptr) std::memcpy(record + 3 + keyLen, *val, valLen);
+
+    const std::size_t size = 3 + keyLen + valLen;
+    const unsigned crc = recordChecksum(record, size);
+    std::memcpy(record + size, &crc, sizeof(crc));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if ((fd_ < 0) || failed_) return 0;
+
+    while (bufSize_ + size + sizeof(crc) > bufCap_) {
+        urgent_ = true;
+        flushCond_.notify_one();
+        durableCond_.wait(lock);
+        if (failed_) return 0;
+    }
+
+    std::memcpy(buf_ + bufSize_, record, size + sizeof(crc));
+    bufSize_ += size + sizeof(crc);
+    if (bufSize_ >= FlushThreshold) flushCond_.notify_one();
+
+    return ++nextLsn_;
+}
+
+unsigned long long WriteAheadLog::logInsert(const WriteAheadLog::String &key, const WriteAheadLog::String &val)
+{
+    return append(Insert, key, &val);
+}
+
+unsigned long long WriteAheadLog::logRemove(const WriteAheadLog::String &key)
+{
+    return append(Remove, key, nullptr);
+}
+
+bool WriteAheadLog::waitDurable(const unsigned long long lsn)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    durableCond_.wait(lock, [&] { return (durableLsn_ >= lsn) || failed_; });
+
+    return !failed_;
+}
+
+bool WriteAheadLog::sync()
+{
+    unsigned long long lsn = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ < 0) return false;
+
+        lsn = nextLsn_;
+        urgent_ = true;
+    }
+    flushCond_.notify_one();
+
+    return waitDurable(lsn);
+}
+
+bool WriteAheadLog::truncate()
+{
+    if (!sync()) return false;
+
+    std::lock_guard<std::mutex> ioLock(ioMutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (bufSize_ != 0) return false;
+
+    return (ftruncate(fd_, 0) == 0) && (fdatasync(fd_) == 0);
+}
+
+void WriteAheadLog::flusherLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (;;) {
+        flushCond_.wait_for(lock, std::chrono::microseconds(commitWindowUs_),
+                            [this] { return stop_ || urgent_ || (bufSize_ >= FlushThreshold); });
+
+        if (bufSize_ == 0) {
+            urgent_ = false;
+            durableCond_.notify_all();
+            if (stop_) return;
+            continue;
+        }
+
+        unsigned char *const data = buf_;
+        const std::size_t size = bufSize_;
+        const unsigned long long lsn = nextLsn_;
+        buf_ = spare_;
+        spare_ = data;
+        bufSize_ = 0;
+        urgent_ = false;
+
+        lock.unlock();
+        std::unique_lock<std::mutex> ioLock(ioMutex_);
+
+        bool written = true;
+        for (std::size_t done = 0; written && (done < size);) {
+            const ssize_t n = write(fd_, data + done, size - done);
+            if (n > 0) {
+                done += n;
+            } else if ((n < 0) && (errno != EINTR)) {
+                written = false;
+            }
+        }
+        written = written && (fdatasync(fd_) == 0);
+
+        ioLock.unlock();
+        lock.lock();
+
+        if (written) {
+            durableLsn_ = lsn;
+        } else {
+            failed_ = true;
+        }
+        durableCond_.notify_all();
+    }
+}
+
+bool WriteAheadLog::replay(const char *const path, const WriteAheadLog::ReplayFunc func, void *const ctx,
+                           std::size_t *const validSize)
+{
+    *validSize = 0;
+
+    MappedFile file;
+    if (!file.open(path)) return errno == ENOENT;
+
+    auto data = reinterpret_cast<const unsigned char *>(file.data());
+    const std::size_t size = file.size();
+
+    std::size_t pos = 0;
+    while (size - pos >= 3 + sizeof(unsigned)) {
+        const unsigned char type = data[pos];
+        const std::size_t keyLen = data[pos + 1];
+        const std::size_t valLen = data[pos + 2];
+        const std::size_t recordSize = 3 + keyLen + valLen;
+
+        if (((type != Insert) && (type != Remove)) || (keyLen >= HashTable::StringSize) ||
+            (valLen >= HashTable::StringSize) || (size - pos < recordSize + sizeof(unsigned))) {
+            break;
+        }
+
+        unsigned crc;
+        std::memcpy(&crc, data + pos + recordSize, sizeof(crc));
+        if (crc != recordChecksum(data + pos, recordSize)) break;
+
+        String key{};
+        String val{};
+        std::memcpy(key, data + pos + 3, keyLen);
+        std::memcpy(val, data + pos + 3 + keyLen, valLen);
+        func(ctx, static_cast<RecordType>(type), key, val);
+
+        pos += recordSize + sizeof(crc);
+    }
+    *validSize = pos;
+
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef WRITEAHEADLOG_HPP
+#define WRITEAHEADLOG_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+#include "HashTable.hpp"
+
+class WriteAheadLog {
+public:
+    typedef HashTable::String String;
+
+    enum RecordType : unsigned char {
+        Insert = 1,
+        Remove = 2
+    };
+
+    typedef void (*ReplayFunc)(void *ctx, RecordType type, const String &key, const String &val);
+
+    static const unsigned DefaultCommitWindowUs = 2000;
+
+    WriteAheadLog() = default;
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    ~WriteAheadLog();
+
+    bool open(const char *path, unsigned commitWindowUs = DefaultCommitWindowUs);
+    void close();
+
+    unsigned long long logInsert(const String &key, const String &val);
+    unsigned long long logRemove(const String &key);
+
+    bool waitDurable(unsigned long long lsn);
+    bool sync();
+    bool truncate();
+
+    static bool replay(const char *path, ReplayFunc func, void *ctx, std::size_t *validSize);
+
+private:
+    static const std::size_t FlushThreshold = 1 << 20;
+    static const std::size_t MaxRecordSize = 3 + 2 * (HashTable::StringSize - 1) + sizeof(unsigned);
+
+    static unsigned recordChecksum(const unsigned char *record, std::size_t size);
+
+    unsigned long long append(RecordType type, const String &key, const String *val);
+    void flusherLoop();
+
+    int fd_{-1};
+    unsigned commitWindowUs_{};
+
+    std::mutex mutex_;
+    std::condition_variable flushCond_;
+    std::condition_variable durableCond_;
+    std::mutex ioMutex_;
+
+    unsigned char *buf_{};
+    unsigned char *spare_{};
+    std::size_t bufSize_{};
+    std::size_t bufCap_{};
+
+    unsigned long long nextLsn_{};
+    unsigned long long durableLsn_{};
+    bool urgent_{};
+    bool failed_{};
+    bool stop_{};
+
+    std::thread flusher_;
+};
+
+#endif /* WRITEAHEADLOG_HPP */
@@ -0,0 +1,27 @@
+#ifndef WYRAND_HPP
+#define WYRAND_HPP
+
+#include <cstddef>
+
+class WyRand {
+public:
+    explicit WyRand(unsigned long long seed) : state_(seed) {}
+
+    unsigned long long next()
+    {
+        state_ += 0xA0761D6478BD642Full;
+        const unsigned __int128 product = static_cast<unsigned __int128>(state_) * (state_ ^ 0xE7037ED1A0B428DBull);
+
+        return static_cast<unsigned long long>(product >> 64) ^ static_cast<unsigned long long>(product);
+    }
+
+    std::size_t nextBelow(std::size_t bound)
+    {
+        return static_cast<std::size_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+    }
+
+private:
+    unsigned long long state_;
+};
+
+#endif /* WYRAND_HPP */
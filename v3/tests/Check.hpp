@@ -0,0 +1,36 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdio>
+
+#include "HashTable.hpp"
+
+// Failures are counted rather than fatal, so one run reports every broken check.
+inline unsigned nCheckFailures = 0;
+
+#define CHECK(cond)                                                                         \
+    do {                                                                                    \
+        if (!(cond)) {                                                                      \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);   \
+            ++nCheckFailures;                                                               \
+        }                                                                                   \
+    } while (0)
+
+// Entries compare on their first 8 bytes, so every key differs within them.
+inline void makeKey(HashTable::String &key, const std::size_t idx)
+{
+    std::snprintf(key, sizeof(key), "k%07zu", idx);
+}
+
+inline int checkResult(const char *name)
+{
+    if (nCheckFailures != 0) {
+        std::fprintf(stderr, "%s: %u checks failed\n", name, nCheckFailures);
+        return 1;
+    }
+
+    std::printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif /* CHECK_HPP */
@@ -0,0 +1,143 @@
+#include <cstdio>
+#include <cstring>
+
+#include <atomic>
+#include <thread>
+
+#include "ConcurrentHashTable.hpp"
+#include "LockFreeHashTable.hpp"
+#include "SeqlockHashTable.hpp"
+#include "ShardedHashTable.hpp"
+#include "tests/Check.hpp"
+
+static const std::size_t NKeys = 20000;
+static const unsigned NThreads = 4;
+
+static HashTable::String keys[NKeys];
+static HashTable::String vals[NKeys];
+
+template <typename Table>
+static bool holds(const Table &table, const std::size_t idx)
+{
+    const HashTable::String *val = table.find(keys[idx]);
+    return (val != nullptr) && (std::strcmp(*val, vals[idx]) == 0);
+}
+
+// Writers fill disjoint ranges of the upper half while readers keep checking the lower half, then every thread
+// removes its share of the odd keys.
+template <typename Table>
+static void testTable(Table &table)
+{
+    const std::size_t nStable = NKeys / 2;
+    for (std::size_t i = 0; i < nStable; ++i) table.insert(keys[i], vals[i]);
+
+    std::atomic<bool> writing{true};
+    std::atomic<std::size_t> nMisses{0};
+    std::thread readers[NThreads];
+    for (unsigned t = 0; t < NThreads; ++t) {
+        readers[t] = std::thread([&, t] {
+            do {
+                for (std::size_t i = t; i < nStable; i += NThreads) {
+                    if (!holds(table, i)) nMisses.fetch_add(1, std::memory_order_relaxed);
+                }
+            } while (writing.load(std::memory_order_acquire));
+        });
+    }
+
+    std::thread writers[NThreads];
+    for (unsigned t = 0; t < NThreads; ++t) {
+        writers[t] = std::thread([&, t] {
+            for (std::size_t i = nStable + t; i < NKeys; i += NThreads) table.insert(keys[i], vals[i]);
+        });
+    }
+    for (auto &writer: writers) writer.join();
+    writing.store(false, std::memory_order_release);
+    for (auto &reader: readers) reader.join();
+
+    CHECK(nMisses.load() == 0);
+    for (std::size_t i = 0; i < NKeys; ++i) CHECK(holds(table, i));
+
+    std::atomic<std::size_t> nRemoved{0};
+    for (unsigned t = 0; t < NThreads; ++t) {
+        writers[t] = std::thread([&, t] {
+            for (std::size_t i = 2 * t + 1; i < NKeys; i += 2 * NThreads) {
+                if (table.remove(keys[i])) nRemoved.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto &writer: writers) writer.join();
+
+    CHECK(nRemoved.load() == NKeys / 2);
+    for (std::size_t i = 0; i < NKeys; ++i) CHECK((i % 2 == 0) ? holds(table, i) : (table.find(keys[i]) == nullptr));
+}
+
+// Shards are owned by one thread at a time rather than locked, so each writer fills the shards it acquires.
+static void testSharded()
+{
+    ShardedHashTable table{crc32Hash, NThreads * 2};
+
+    CHECK(table.acquireShard(0) != nullptr);
+    CHECK(table.acquireShard(0) == nullptr);
+    table.releaseShard(0);
+
+    const HashTable::String *keyPtrs[NKeys];
+    for (std::size_t i = 0; i < NKeys; ++i) keyPtrs[i] = &keys[i];
+    auto shardStarts = new std::size_t[table.nShards() + 1];
+    auto order = new std::size_t[NKeys];
+    table.route(keyPtrs, NKeys, shardStarts, order);
+
+    std::atomic<std::size_t> nextShard{0};
+    std::atomic<std::size_t> nBusy{0};
+    std::thread writers[NThreads];
+    for (auto &writer: writers) {
+        writer = std::thread([&] {
+            for (std::size_t s; (s = nextShard.fetch_add(1)) < table.nShards();) {
+                HashTable *shard = table.acquireShard(s);
+                if (shard == nullptr) {
+                    nBusy.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                for (std::size_t i = shardStarts[s]; i < shardStarts[s + 1]; ++i) {
+                    shard->insert(keys[order[i]], vals[order[i]]);
+                }
+                table.releaseShard(s);
+            }
+        });
+    }
+    for (auto &writer: writers) writer.join();
+
+    CHECK(nBusy.load() == 0);
+    for (std::size_t i = 0; i < NKeys; ++i) {
+        CHECK(holds(table, i));
+        CHECK(table.shard(table.shardIdx(keys[i])).find(keys[i]) != nullptr);
+    }
+
+    delete[] order;
+    delete[] shardStarts;
+}
+
+signed main()
+{
+    for (std::size_t i = 0; i < NKeys; ++i) {
+        makeKey(keys[i], i);
+        std::snprintf(vals[i], sizeof(vals[i]), "v%zu", i);
+    }
+
+    {
+        ConcurrentHashTable table{crc32Hash, 8};
+        testTable(table);
+        CHECK(table.size() == NKeys / 2);
+    }
+    {
+        SeqlockHashTable table{crc32Hash};
+        testTable(table);
+    }
+    {
+        LockFreeHashTable table{crc32Hash, 2 * NKeys};
+        testTable(table);
+    }
+    testSharded();
+
+    return checkResult("ConcurrentTest");
+}
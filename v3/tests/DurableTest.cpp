@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "DurableHashTable.hpp"
+#include "WriteAheadLog.hpp"
+#include "tests/Check.hpp"
+
+static const std::size_t NKeys = 1000;
+
+static HashTable::String keys[NKeys];
+static HashTable::String vals[NKeys];
+
+struct Replayed {
+    std::size_t nInserts;
+    std::size_t nRemoves;
+    bool ordered;
+};
+
+static void countRecord(void *ctx, const WriteAheadLog::RecordType type, const HashTable::String &key,
+                        const HashTable::String &val)
+{
+    auto replayed = static_cast<Replayed *>(ctx);
+    if (type == WriteAheadLog::Insert) {
+        const std::size_t idx = replayed->nInserts++;
+        replayed->ordered = replayed->ordered && (std::strcmp(key, keys[idx]) == 0) &&
+                            (std::strcmp(val, vals[idx]) == 0);
+    } else {
+        const std::size_t idx = 2 * replayed->nRemoves++;
+        replayed->ordered = replayed->ordered && (replayed->nInserts == NKeys) && (std::strcmp(key, keys[idx]) == 0);
+    }
+}
+
+static void testReplay(const char *path)
+{
+    WriteAheadLog log;
+    CHECK(log.open(path));
+    for (std::size_t i = 0; i < NKeys; ++i) CHECK(log.logInsert(keys[i], vals[i]) != 0);
+    for (std::size_t i = 0; i < NKeys; i += 2) CHECK(log.logRemove(keys[i]) != 0);
+    CHECK(log.sync());
+    log.close();
+
+    Replayed replayed{0, 0, true};
+    std::size_t validSize = 0;
+    CHECK(WriteAheadLog::replay(path, countRecord, &replayed, &validSize));
+    CHECK(replayed.nInserts == NKeys);
+    CHECK(replayed.nRemoves == NKeys / 2);
+    CHECK(replayed.ordered);
+
+    // A torn last record is dropped and the valid prefix is reported.
+    CHECK(truncate(path, validSize - 1) == 0);
+    replayed = Replayed{0, 0, true};
+    std::size_t tornSize = 0;
+    CHECK(WriteAheadLog::replay(path, countRecord, &replayed, &tornSize));
+    CHECK(replayed.nRemoves == NKeys / 2 - 1);
+    CHECK(tornSize < validSize);
+
+    replayed = Replayed{0, 0, true};
+    CHECK(WriteAheadLog::replay("/nonexistent-wal", countRecord, &replayed, &validSize));
+    CHECK((validSize == 0) && (replayed.nInserts == 0));
+
+    unlink(path);
+}
+
+static bool holds(const DurableHashTable &table, const std::size_t idx)
+{
+    const HashTable::String *val = table.find(keys[idx]);
+    return (val != nullptr) && (std::strcmp(*val, vals[idx]) == 0);
+}
+
+static void testRecovery(const char *snapshotPath, const char *logPath)
+{
+    {
+        DurableHashTable table{crc32Hash};
+        CHECK(table.open(snapshotPath, logPath));
+        for (std::size_t i = 0; i < NKeys / 2; ++i) CHECK(table.insert(keys[i], vals[i]));
+        CHECK(!table.insert(keys[0], vals[1]));
+        CHECK(table.remove(keys[0]));
+        CHECK(table.sync());
+    }
+
+    // The log alone rebuilds the table.
+    {
+        DurableHashTable table{crc32Hash};
+        CHECK(table.open(snapshotPath, logPath));
+        CHECK(table.find(keys[0]) == nullptr);
+        for (std::size_t i = 1; i < NKeys / 2; ++i) CHECK(holds(table, i));
+
+        CHECK(table.checkpoint());
+        CHECK(access(snapshotPath, F_OK) == 0);
+        for (std::size_t i = NKeys / 2; i < NKeys; ++i) CHECK(table.insert(keys[i], vals[i]));
+        CHECK(table.remove(keys[1]));
+        CHECK(table.sync());
+    }
+
+    // The snapshot plus the log written after the checkpoint rebuild it again.
+    {
+        DurableHashTable table{crc32Hash};
+        CHECK(table.open(snapshotPath, logPath));
+        CHECK(table.find(keys[0]) == nullptr);
+        CHECK(table.find(keys[1]) == nullptr);
+        for (std::size_t i = 2; i < NKeys; ++i) CHECK(holds(table, i));
+    }
+
+    unlink(snapshotPath);
+    unlink(logPath);
+}
+
+signed main()
+{
+    for (std::size_t i = 0; i < NKeys; ++i) {
+        makeKey(keys[i], i);
+        std::snprintf(vals[i], sizeof(vals[i]), "v%zu", i);
+    }
+
+    char dir[] = "/tmp/DurableTestXXXXXX";
+    if (mkdtemp(dir) == nullptr) return EXIT_FAILURE;
+
+    char walPath[sizeof(dir) + 16];
+    char snapshotPath[sizeof(dir) + 16];
+    char logPath[sizeof(dir) + 16];
+    std::snprintf(walPath, sizeof(walPath), "%s/replay.wal", dir);
+    std::snprintf(snapshotPath, sizeof(snapshotPath), "%s/table.snap", dir);
+    std::snprintf(logPath, sizeof(logPath), "%s/table.wal", dir);
+
+    testReplay(walPath);
+    testRecovery(snapshotPath, logPath);
+
+    rmdir(dir);
+
+    return checkResult("DurableTest");
+}
@@ -0,0 +1,146 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "HashTable.hpp"
+#include "tests/Check.hpp"
+
+static const std::size_t NKeys = 5000;
+
+static HashTable::String keys[NKeys];
+static HashTable::String vals[NKeys];
+
+static void fill(HashTable &table)
+{
+    for (std::size_t i = 0; i < NKeys; ++i) CHECK(table.insert(keys[i], vals[i]));
+}
+
+static bool holds(const HashTable &table, const std::size_t begin, const std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i) {
+        const HashTable::String *val = table.find(keys[i]);
+        if ((val == nullptr) || (std::strcmp(*val, vals[i]) != 0)) return false;
+    }
+
+    return true;
+}
+
+static void testInsertRemove()
+{
+    HashTable table{crc32Hash};
+    fill(table);
+
+    CHECK(!table.insert(keys[0], vals[1]));
+    CHECK(holds(table, 0, NKeys));
+
+    for (std::size_t i = 0; i < NKeys; i += 2) CHECK(table.remove(keys[i]));
+    CHECK(!table.remove(keys[0]));
+    for (std::size_t i = 0; i < NKeys; ++i) CHECK((table.find(keys[i]) == nullptr) == (i % 2 == 0));
+
+    table.clear();
+    CHECK(table.find(keys[1]) == nullptr);
+}
+
+static void testFreezeThaw()
+{
+    HashTable table{crc32Hash};
+    fill(table);
+
+    table.freeze();
+    CHECK(table.frozen());
+    CHECK(holds(table, 0, NKeys));
+    CHECK(!table.insert(keys[0], vals[0]));
+    CHECK(!table.remove(keys[0]));
+
+    HashTable::String missing{};
+    makeKey(missing, NKeys);
+    CHECK(table.find(missing) == nullptr);
+
+    CHECK(table.thaw());
+    CHECK(!table.frozen());
+    CHECK(holds(table, 0, NKeys));
+    CHECK(table.remove(keys[0]));
+    CHECK(table.insert(missing, vals[0]));
+
+    table.freeze();
+    CHECK(table.find(keys[0]) == nullptr);
+    CHECK(table.find(missing) != nullptr);
+    CHECK(holds(table, 1, NKeys));
+}
+
+static void testFrontCoded()
+{
+    HashTable table{crc32Hash};
+    fill(table);
+
+    table.freeze(true);
+    CHECK(table.frozen());
+    CHECK(holds(table, 0, NKeys));
+    CHECK(!table.thaw());
+    CHECK(!table.save("/dev/null"));
+}
+
+static void testSaveLoad(const char *path)
+{
+    HashTable table{crc32Hash};
+    fill(table);
+    CHECK(!table.save(path));
+
+    table.freeze();
+    CHECK(table.save(path));
+
+    HashTable loaded{crc32Hash};
+    CHECK(loaded.load(path));
+    CHECK(loaded.frozen());
+    CHECK(holds(loaded, 0, NKeys));
+
+    // A loaded snapshot thaws into an ordinary table that can change and be saved again.
+    CHECK(loaded.thaw());
+    CHECK(loaded.remove(keys[0]));
+    loaded.freeze();
+    CHECK(loaded.save(path));
+
+    HashTable reloaded{crc32Hash};
+    CHECK(reloaded.load(path));
+    CHECK(reloaded.find(keys[0]) == nullptr);
+    CHECK(holds(reloaded, 1, NKeys));
+
+    // Flip one byte past the header; the checksum must catch it.
+    std::FILE *stream = std::fopen(path, "r+b");
+    CHECK(stream != nullptr);
+    if (stream != nullptr) {
+        CHECK(std::fseek(stream, 128, SEEK_SET) == 0);
+        const int byte = std::fgetc(stream);
+        CHECK(std::fseek(stream, 128, SEEK_SET) == 0);
+        std::fputc(byte ^ 0xFF, stream);
+        std::fclose(stream);
+    }
+    CHECK(!reloaded.load(path));
+    CHECK(reloaded.find(keys[1]) == nullptr);
+
+    CHECK(!reloaded.load("/nonexistent/snapshot"));
+}
+
+signed main()
+{
+    for (std::size_t i = 0; i < NKeys; ++i) {
+        makeKey(keys[i], i);
+        std::snprintf(vals[i], sizeof(vals[i]), "v%zu", i);
+    }
+
+    char path[] = "/tmp/HashTableTestXXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) return EXIT_FAILURE;
+    close(fd);
+
+    testInsertRemove();
+    testFreezeThaw();
+    testFrontCoded();
+    testSaveLoad(path);
+
+    unlink(path);
+
+    return checkResult("HashTableTest");
+}